@@ -0,0 +1,181 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <rte_eal.h>
+#include <rte_debug.h>
+#include <rte_cycles.h>
+#include <rte_cpuflags.h>
+
+#include <logger_config.h>
+#include <aggregate_kernels.h>
+#include <dpdk_metric_interface.h>
+
+#define DEFAULT_CELL_COUNT 16384
+#define BENCH_ROUNDS 1000
+
+// Per cell loop the DRB callback used before the kernels. Kept here as the baseline.
+static void aggregate_per_cell(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result){
+    result->min_low = UINT32_MAX;
+    result->max_low = 0;
+    result->min_high = UINT32_MAX;
+    result->max_high = 0;
+    result->sum_low = 0;
+    result->sum_high = 0;
+
+    for(uint32_t i = 0; i < count; i++){
+        uint32_t active_count = packed_counts[i] & 0x00000000FFFFFFFFUL;
+        uint32_t inactive_count = packed_counts[i] >> 32;
+
+        result->max_low = GENERIC_MAX(result->max_low, active_count);
+        result->min_low = GENERIC_MIN(result->min_low, active_count);
+
+        result->max_high = GENERIC_MAX(result->max_high, inactive_count);
+        result->min_high = GENERIC_MIN(result->min_high, inactive_count);
+
+        result->sum_low += active_count;
+        result->sum_high += inactive_count;
+    }
+}
+
+// Every kernel must give exactly the result of the per cell loop, otherwise its timing means nothing.
+static bool run_kernel(const char *name, packed_count_aggregate_fn kernel, const std::vector<uint64_t> &cells){
+    packed_count_aggregate result;
+    packed_count_aggregate expected;
+    uint64_t checksum = 0;
+
+    aggregate_per_cell(cells.data(), cells.size(), &expected);
+
+    // Warm up the cache so that every kernel sees the same state.
+    kernel(cells.data(), cells.size(), &result);
+
+    if(result.min_low != expected.min_low || result.max_low != expected.max_low || result.sum_low != expected.sum_low ||
+            result.min_high != expected.min_high || result.max_high != expected.max_high || result.sum_high != expected.sum_high){
+        printf("%-10s gives a different result than the per cell loop\n", name);
+        return false;
+    }
+
+    uint64_t start = rte_rdtsc();
+
+    for(int i = 0; i < BENCH_ROUNDS; i++){
+        kernel(cells.data(), cells.size(), &result);
+        checksum += result.sum_low + result.max_high;
+    }
+
+    uint64_t cycles = rte_rdtsc() - start;
+
+    printf("%-10s %8.3f cycles per cell (checksum %" PRIu64 ")\n", name, 
+                (double) cycles / ((double) BENCH_ROUNDS * cells.size()), checksum);
+
+    return true;
+}
+
+// Gathering cell counts from rte_metrics, which can only return the whole table. The DRB callback reads the table
+// once per sampling, reading it once per cell is kept here as the baseline.
+static void run_gather(uint32_t cell_count){
+    DPDKMetricInterface metrics;
+    int socket_id = rte_socket_id();
+    std::vector<int> metric_ids;
+    std::vector<uint64_t> cells;
+    std::vector<uint64_t> table;
+    uint64_t start;
+
+    metrics.initialize_metrics(&socket_id);
+
+    for(uint32_t i = 0; i < cell_count; i++){
+        std::string name = "bench_cell_" + std::to_string(i);
+        int id;
+
+        if(!metrics.register_metric(name.c_str(), id)){
+            break;
+        }
+
+        metrics.update_metric(id, i, true);
+        metric_ids.push_back(id);
+    }
+
+    if(metric_ids.empty()){
+        printf("No metric could be registered, gather is not measured\n");
+        return;
+    }
+
+    cells.resize(metric_ids.size());
+    printf("Gathering %zu cells from rte_metrics %d times\n", metric_ids.size(), BENCH_ROUNDS);
+
+    start = rte_rdtsc();
+
+    for(int i = 0; i < BENCH_ROUNDS; i++){
+        for(unsigned int j = 0; j < metric_ids.size(); j++){
+            metrics.get_metric(metric_ids[j], cells[j]);
+        }
+    }
+
+    printf("%-10s %8.3f cycles per cell\n", "per cell", (double) (rte_rdtsc() - start) / ((double) BENCH_ROUNDS * metric_ids.size()));
+
+    start = rte_rdtsc();
+
+    for(int i = 0; i < BENCH_ROUNDS; i++){
+        metrics.get_all_metrics(table);
+
+        for(unsigned int j = 0; j < metric_ids.size(); j++){
+            cells[j] = table[metric_ids[j]];
+        }
+    }
+
+    printf("%-10s %8.3f cycles per cell\n", "table", (double) (rte_rdtsc() - start) / ((double) BENCH_ROUNDS * metric_ids.size()));
+}
+
+int main(int argc, char **argv){
+    int ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_panic("Cannot init EAL\n");
+
+    argc -= ret;
+    argv += ret;
+
+    int cell_argument = argc > 1 ? atoi(argv[1]) : DEFAULT_CELL_COUNT;
+
+    if(cell_argument <= 0){
+        printf("Usage: aggregate_bench [EAL options] -- [cell count > 0]\n");
+        rte_eal_cleanup();
+        return 1;
+    }
+
+    uint32_t cell_count = cell_argument;
+    std::vector<uint64_t> cells(cell_count);
+    bool matched = true;
+
+    srand(42);
+    for(uint32_t i = 0; i < cell_count; i++){
+        uint64_t active_count = rand() % 1000;
+        uint64_t inactive_count = rand() % 1000;
+
+        cells[i] = active_count + (inactive_count << 32);
+    }
+
+    printf("Aggregating %u cells %d times\n", cell_count, BENCH_ROUNDS);
+
+    matched &= run_kernel("per cell", aggregate_per_cell, cells);
+    matched &= run_kernel("scalar", aggregate_packed_counts_scalar, cells);
+
+#ifdef RTE_ARCH_X86
+    if(rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1))
+        matched &= run_kernel("sse4.1", aggregate_packed_counts_sse41, cells);
+
+    if(rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+        matched &= run_kernel("avx2", aggregate_packed_counts_avx2, cells);
+
+    if(rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F))
+        matched &= run_kernel("avx512", aggregate_packed_counts_avx512, cells);
+#endif
+
+    matched &= run_kernel("selected", select_packed_count_aggregate_kernel(), cells);
+
+    // rte_metrics holds at most RTE_METRICS_MAX_METRICS metrics, registration stops there.
+    run_gather(cell_count);
+
+    rte_eal_cleanup();
+    return matched ? 0 : 1;
+}
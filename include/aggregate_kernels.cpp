@@ -0,0 +1,183 @@
+#include "aggregate_kernels.h"
+#include "rte_cpuflags.h"
+#include "rte_vect.h"
+
+#ifdef RTE_ARCH_X86
+#include <immintrin.h>
+#endif
+
+#define LOW_32_MASK 0x00000000FFFFFFFFUL
+
+
+// Fold a single packed value into the result.
+static inline void aggregate_packed_count(uint64_t packed_count, packed_count_aggregate *result){
+    uint32_t low = packed_count & LOW_32_MASK;
+    uint32_t high = packed_count >> 32;
+
+    result->min_low = RTE_MIN(result->min_low, low);
+    result->max_low = RTE_MAX(result->max_low, low);
+    result->min_high = RTE_MIN(result->min_high, high);
+    result->max_high = RTE_MAX(result->max_high, high);
+    result->sum_low += low;
+    result->sum_high += high;
+}
+
+static inline void reset_aggregate(packed_count_aggregate *result){
+    result->min_low = UINT32_MAX;
+    result->max_low = 0;
+    result->min_high = UINT32_MAX;
+    result->max_high = 0;
+    result->sum_low = 0;
+    result->sum_high = 0;
+}
+
+// Fold vector lanes into the result. Even 32 bit lanes are lower halves and odd lanes are upper halves.
+static inline void reduce_lanes(const uint32_t *min_lanes, const uint32_t *max_lanes, const uint64_t *low_sums, 
+                                    const uint64_t *high_sums, unsigned int packed_lanes, packed_count_aggregate *result){
+    for(unsigned int i = 0; i < packed_lanes; i++){
+        result->min_low = RTE_MIN(result->min_low, min_lanes[2 * i]);
+        result->max_low = RTE_MAX(result->max_low, max_lanes[2 * i]);
+        result->min_high = RTE_MIN(result->min_high, min_lanes[2 * i + 1]);
+        result->max_high = RTE_MAX(result->max_high, max_lanes[2 * i + 1]);
+        result->sum_low += low_sums[i];
+        result->sum_high += high_sums[i];
+    }
+}
+
+
+void aggregate_packed_counts_scalar(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result){
+    reset_aggregate(result);
+
+    for(uint32_t i = 0; i < count; i++){
+        aggregate_packed_count(packed_counts[i], result);
+    }
+}
+
+
+#ifdef RTE_ARCH_X86
+
+// Min and max are taken on all 32 bit lanes at once. For the sums, halves are split into 64 bit lanes so they can not overflow.
+__attribute__((target("sse4.1")))
+void aggregate_packed_counts_sse41(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result){
+    __m128i min_vector = _mm_set1_epi32(-1);
+    __m128i max_vector = _mm_setzero_si128();
+    __m128i low_sum = _mm_setzero_si128();
+    __m128i high_sum = _mm_setzero_si128();
+    __m128i low_mask = _mm_set1_epi64x(LOW_32_MASK);
+    uint32_t i = 0;
+
+    for(; i + 2 <= count; i += 2){
+        __m128i values = _mm_loadu_si128((const __m128i *) &packed_counts[i]);
+
+        min_vector = _mm_min_epu32(min_vector, values);
+        max_vector = _mm_max_epu32(max_vector, values);
+        low_sum = _mm_add_epi64(low_sum, _mm_and_si128(values, low_mask));
+        high_sum = _mm_add_epi64(high_sum, _mm_srli_epi64(values, 32));
+    }
+
+    uint32_t min_lanes[4], max_lanes[4];
+    uint64_t low_sums[2], high_sums[2];
+
+    _mm_storeu_si128((__m128i *) min_lanes, min_vector);
+    _mm_storeu_si128((__m128i *) max_lanes, max_vector);
+    _mm_storeu_si128((__m128i *) low_sums, low_sum);
+    _mm_storeu_si128((__m128i *) high_sums, high_sum);
+
+    reset_aggregate(result);
+    reduce_lanes(min_lanes, max_lanes, low_sums, high_sums, 2, result);
+
+    for(; i < count; i++){
+        aggregate_packed_count(packed_counts[i], result);
+    }
+}
+
+
+__attribute__((target("avx2")))
+void aggregate_packed_counts_avx2(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result){
+    __m256i min_vector = _mm256_set1_epi32(-1);
+    __m256i max_vector = _mm256_setzero_si256();
+    __m256i low_sum = _mm256_setzero_si256();
+    __m256i high_sum = _mm256_setzero_si256();
+    __m256i low_mask = _mm256_set1_epi64x(LOW_32_MASK);
+    uint32_t i = 0;
+
+    for(; i + 4 <= count; i += 4){
+        __m256i values = _mm256_loadu_si256((const __m256i *) &packed_counts[i]);
+
+        min_vector = _mm256_min_epu32(min_vector, values);
+        max_vector = _mm256_max_epu32(max_vector, values);
+        low_sum = _mm256_add_epi64(low_sum, _mm256_and_si256(values, low_mask));
+        high_sum = _mm256_add_epi64(high_sum, _mm256_srli_epi64(values, 32));
+    }
+
+    uint32_t min_lanes[8], max_lanes[8];
+    uint64_t low_sums[4], high_sums[4];
+
+    _mm256_storeu_si256((__m256i *) min_lanes, min_vector);
+    _mm256_storeu_si256((__m256i *) max_lanes, max_vector);
+    _mm256_storeu_si256((__m256i *) low_sums, low_sum);
+    _mm256_storeu_si256((__m256i *) high_sums, high_sum);
+
+    reset_aggregate(result);
+    reduce_lanes(min_lanes, max_lanes, low_sums, high_sums, 4, result);
+
+    for(; i < count; i++){
+        aggregate_packed_count(packed_counts[i], result);
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void aggregate_packed_counts_avx512(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result){
+    __m512i min_vector = _mm512_set1_epi32(-1);
+    __m512i max_vector = _mm512_setzero_si512();
+    __m512i low_sum = _mm512_setzero_si512();
+    __m512i high_sum = _mm512_setzero_si512();
+    __m512i low_mask = _mm512_set1_epi64(LOW_32_MASK);
+    uint32_t i = 0;
+
+    for(; i + 8 <= count; i += 8){
+        __m512i values = _mm512_loadu_si512((const void *) &packed_counts[i]);
+
+        min_vector = _mm512_min_epu32(min_vector, values);
+        max_vector = _mm512_max_epu32(max_vector, values);
+        low_sum = _mm512_add_epi64(low_sum, _mm512_and_si512(values, low_mask));
+        high_sum = _mm512_add_epi64(high_sum, _mm512_srli_epi64(values, 32));
+    }
+
+    uint32_t min_lanes[16], max_lanes[16];
+    uint64_t low_sums[8], high_sums[8];
+
+    _mm512_storeu_si512((void *) min_lanes, min_vector);
+    _mm512_storeu_si512((void *) max_lanes, max_vector);
+    _mm512_storeu_si512((void *) low_sums, low_sum);
+    _mm512_storeu_si512((void *) high_sums, high_sum);
+
+    reset_aggregate(result);
+    reduce_lanes(min_lanes, max_lanes, low_sums, high_sums, 8, result);
+
+    for(; i < count; i++){
+        aggregate_packed_count(packed_counts[i], result);
+    }
+}
+
+#endif
+
+
+packed_count_aggregate_fn select_packed_count_aggregate_kernel(){
+#ifdef RTE_ARCH_X86
+    if(rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) && rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_512){
+        return aggregate_packed_counts_avx512;
+    }
+
+    if(rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) && rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256){
+        return aggregate_packed_counts_avx2;
+    }
+
+    if(rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1) && rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_128){
+        return aggregate_packed_counts_sse41;
+    }
+#endif
+
+    return aggregate_packed_counts_scalar;
+}
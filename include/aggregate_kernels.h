@@ -0,0 +1,44 @@
+#ifndef DPDK_LOGGER_AGGREGATE_KERNELS_H
+#define DPDK_LOGGER_AGGREGATE_KERNELS_H
+
+#include "rte_common.h"
+
+/** Min, max and sum of packed cell counts. Each packed count holds two 32 bit values, lower half is the active UE count
+ * and upper half is the inactive UE count of a cell. This is the same layout that per DRB per cell metrics use.
+ * */
+struct packed_count_aggregate{
+
+    uint32_t min_low;
+
+    uint32_t max_low;
+
+    uint32_t min_high;
+
+    uint32_t max_high;
+
+    uint64_t sum_low;
+
+    uint64_t sum_high;
+};
+
+// Aggregate @param count packed values into @param result. Result is overwritten. Count must be at least 1.
+typedef void (*packed_count_aggregate_fn)(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result);
+
+// Plain loop, available everywhere.
+void aggregate_packed_counts_scalar(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result);
+
+#ifdef RTE_ARCH_X86
+// SIMD kernels. They must only be called if the CPU supports the instruction set.
+void aggregate_packed_counts_sse41(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result);
+
+void aggregate_packed_counts_avx2(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result);
+
+void aggregate_packed_counts_avx512(const uint64_t *packed_counts, uint32_t count, packed_count_aggregate *result);
+#endif
+
+/** Select the widest kernel supported by the CPU and allowed by the EAL max SIMD bitwidth.
+ * AVX-512 is only selected if EAL is started with --force-max-simd-bitwidth=512 as other DPDK libraries do.
+ * **/
+packed_count_aggregate_fn select_packed_count_aggregate_kernel();
+
+#endif
@@ -1,13 +1,18 @@
 #include "dpdk_metric_interface.h"
+#include "rte_memory.h"
 
 
 
-DPDKMetricInterface::DPDKMetricInterface(){
+DPDKMetricInterface::DPDKMetricInterface() : socket_id(SOCKET_ID_ANY), initialized(false){
 
 }
 
 
 DPDKMetricInterface::~DPDKMetricInterface(){
+    if(!initialized){
+        return;
+    }
+
     rte_metrics_deinit();
     printf("Metric Interface is destroyed\n");
 }
@@ -16,6 +21,7 @@ DPDKMetricInterface::~DPDKMetricInterface(){
 bool DPDKMetricInterface::initialize_metrics(void *data){
     socket_id = *((int *)data);
     rte_metrics_init(socket_id);
+    initialized = true;
 
     return true;
 }
@@ -41,49 +47,78 @@ bool DPDKMetricInterface::update_metric(int metric_id, int64_t value, bool absol
         uint64_t current_value;
         if(get_metric(metric_id, current_value)){
             current_value += value;
-            return (rte_metrics_update_value(socket_id, metric_id, value)) >= 0;
+            return (rte_metrics_update_value(socket_id, metric_id, current_value)) >= 0;
         }
 
         return false;
     }
 }
 
-bool DPDKMetricInterface::get_metric(int metric_id, uint64_t &metric_value){
-    struct rte_metric_value *metrics;
+int DPDKMetricInterface::read_value_table(std::vector<struct rte_metric_value> &value_table){
     int len;
     int ret;
-    int i;
 
     len = rte_metrics_get_names(NULL, 0);
     
     if (len < 0) {
         printf("Cannot get metrics count\n");
-        return false;
+        return -1;
     }
     if (len == 0) {
         printf("No metrics to display (none have been registered)\n");
+        return -1;
+    }
+
+    value_table.resize(len);
+
+    ret = rte_metrics_get_values(socket_id, value_table.data(), len);
+    if (ret < 0 || ret > len) {
+        printf("Cannot get metrics values\n");
+        return -1;
+    }
+
+    return ret;
+}
+
+bool DPDKMetricInterface::get_metric(int metric_id, uint64_t &metric_value){
+    std::vector<struct rte_metric_value> value_table;
+    int len = read_value_table(value_table);
+
+    if(len < 0){
         return false;
     }
 
-    metrics = (struct rte_metric_value*) malloc(sizeof(struct rte_metric_value) * len);
+    for(int i = 0; i < len; i++){
+        if(value_table[i].key == (uint64_t) metric_id){
+            metric_value = value_table[i].value;
+            return true;
+        }
+    }
 
-    if (metrics == NULL) {
-        printf("Cannot allocate memory\n");
-        free(metrics);
+    return false;
+}
+
+bool DPDKMetricInterface::get_and_reset_metric(int metric_id, uint64_t &metric_value){
+    if(!get_metric(metric_id, metric_value)){
         return false;
     }
 
-    ret = rte_metrics_get_values(socket_id, metrics, len);
-    if (ret < 0 || ret > len) {
-        printf("Cannot get metrics values\n");
-        free(metrics);
+    return (rte_metrics_update_value(socket_id, metric_id, 0)) >= 0;
+}
+
+bool DPDKMetricInterface::get_all_metrics(std::vector<uint64_t> &metric_values){
+    std::vector<struct rte_metric_value> value_table;
+    int len = read_value_table(value_table);
+
+    if(len < 0){
         return false;
     }
 
-    for(i = 0; i < len; i++){
-        if(metrics[i].key == metric_id){
-            metric_value = metrics[i].value;
-            break;
+    metric_values.assign(len, 0);
+
+    for(int i = 0; i < len; i++){
+        if(value_table[i].key < (uint64_t) len){
+            metric_values[value_table[i].key] = value_table[i].value;
         }
     }
 
@@ -19,11 +19,24 @@ class DPDKMetricInterface : public MetricInterface {
 
         bool get_metric(int metric_id, uint64_t &metric_value);
 
+        bool get_and_reset_metric(int metric_id, uint64_t &metric_value);
+
+        bool get_all_metrics(std::vector<uint64_t> &metric_values);
+
     protected:
         void print_metrics();
 
     private:
         int socket_id;
+
+        // rte_metrics is only deinitialized if it was initialized through this interface.
+        bool initialized;
+
+        /** Read the whole rte_metrics table, which is the only way rte_metrics returns values. Table is passed in
+         * so that reads from different lcores do not share a buffer.
+         * @returns Number of metrics, -1 on failure
+         * **/
+        int read_value_table(std::vector<struct rte_metric_value> &value_table);
 };
 
 #endif
\ No newline at end of file
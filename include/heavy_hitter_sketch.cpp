@@ -0,0 +1,127 @@
+#include "heavy_hitter_sketch.h"
+#include "string.h"
+
+
+// Odd multipliers for multiply-shift hashing, one per row.
+static const uint64_t row_seeds[] = {
+    0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL,
+    0xFF51AFD7ED558CCDULL, 0xC4CEB9FE1A85EC53ULL, 0x94D049BB133111EBULL, 0xBF58476D1CE4E5B9ULL
+};
+
+static inline uint32_t sketch_index(unsigned int row, uint32_t key){
+    uint64_t hash = ((uint64_t) key + 1) * row_seeds[row];
+    return row * HEAVY_HITTER_SKETCH_WIDTH + (uint32_t) (hash >> (64 - HEAVY_HITTER_SKETCH_WIDTH_BITS));
+}
+
+
+HeavyHitterSketch::HeavyHitterSketch() : counters(NULL), top_k(0), candidate_count(0), min_candidate(0), total_weight(0){
+    static_assert(HEAVY_HITTER_SKETCH_DEPTH <= sizeof(row_seeds) / sizeof(row_seeds[0]), "Not enough row seeds for the sketch depth");
+}
+
+HeavyHitterSketch::~HeavyHitterSketch(){
+    rte_free(counters);
+}
+
+bool HeavyHitterSketch::initialize(unsigned int k, int socket_id){
+    if(k == 0 || k > HEAVY_HITTER_MAX_K){
+        return false;
+    }
+
+    counters = (uint64_t *) rte_zmalloc_socket("logger_heavy_hitter", sizeof(uint64_t) * HEAVY_HITTER_SKETCH_COUNTERS,
+                                                RTE_CACHE_LINE_SIZE, socket_id);
+    top_k = k;
+
+    return counters != NULL;
+}
+
+void HeavyHitterSketch::update(uint32_t key, uint64_t weight){
+    uint64_t key_estimate = UINT64_MAX;
+
+    for(unsigned int row = 0; row < HEAVY_HITTER_SKETCH_DEPTH; row++){
+        uint64_t &counter = counters[sketch_index(row, key)];
+
+        counter += weight;
+        key_estimate = RTE_MIN(key_estimate, counter);
+    }
+
+    total_weight += weight;
+
+    for(unsigned int i = 0; i < candidate_count; i++){
+        if(candidate_keys[i] == key){
+            candidate_counts[i] = key_estimate;
+
+            if(i == min_candidate && candidate_count == top_k){
+                find_min_candidate();
+            }
+
+            return;
+        }
+    }
+
+    if(candidate_count < top_k){
+        candidate_keys[candidate_count] = key;
+        candidate_counts[candidate_count] = key_estimate;
+        candidate_count++;
+
+        if(candidate_count == top_k){
+            find_min_candidate();
+        }
+
+        return;
+    }
+
+    if(key_estimate > candidate_counts[min_candidate]){
+        candidate_keys[min_candidate] = key;
+        candidate_counts[min_candidate] = key_estimate;
+        find_min_candidate();
+    }
+}
+
+uint64_t HeavyHitterSketch::estimate(uint32_t key) const {
+    return estimate(counters, key);
+}
+
+uint64_t HeavyHitterSketch::estimate(const uint64_t *sketch_counters, uint32_t key){
+    uint64_t key_estimate = UINT64_MAX;
+
+    for(unsigned int row = 0; row < HEAVY_HITTER_SKETCH_DEPTH; row++){
+        key_estimate = RTE_MIN(key_estimate, sketch_counters[sketch_index(row, key)]);
+    }
+
+    return key_estimate;
+}
+
+void HeavyHitterSketch::add_counters_to(uint64_t *sum_counters) const {
+    for(unsigned int i = 0; i < HEAVY_HITTER_SKETCH_COUNTERS; i++){
+        sum_counters[i] += counters[i];
+    }
+}
+
+void HeavyHitterSketch::reset(){
+    memset(counters, 0, sizeof(uint64_t) * HEAVY_HITTER_SKETCH_COUNTERS);
+    candidate_count = 0;
+    min_candidate = 0;
+    total_weight = 0;
+}
+
+unsigned int HeavyHitterSketch::get_candidate_count() const {
+    return candidate_count;
+}
+
+const uint32_t *HeavyHitterSketch::get_candidate_keys() const {
+    return candidate_keys;
+}
+
+uint64_t HeavyHitterSketch::get_total_weight() const {
+    return total_weight;
+}
+
+void HeavyHitterSketch::find_min_candidate(){
+    min_candidate = 0;
+
+    for(unsigned int i = 1; i < candidate_count; i++){
+        if(candidate_counts[i] < candidate_counts[min_candidate]){
+            min_candidate = i;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef DPDK_LOGGER_HEAVY_HITTER_SKETCH_H
+#define DPDK_LOGGER_HEAVY_HITTER_SKETCH_H
+
+#include "rte_common.h"
+#include "rte_malloc.h"
+
+// Count-min sketch dimensions. Estimates exceed the real count by at most e / WIDTH of the total weight
+// with probability 1 - e^-DEPTH. Width must be a power of two.
+#ifndef HEAVY_HITTER_SKETCH_DEPTH
+    #define HEAVY_HITTER_SKETCH_DEPTH 4
+#endif
+
+#ifndef HEAVY_HITTER_SKETCH_WIDTH_BITS
+    #define HEAVY_HITTER_SKETCH_WIDTH_BITS 10
+#endif
+
+#define HEAVY_HITTER_SKETCH_WIDTH (1U << HEAVY_HITTER_SKETCH_WIDTH_BITS)
+
+#define HEAVY_HITTER_SKETCH_COUNTERS (HEAVY_HITTER_SKETCH_DEPTH * HEAVY_HITTER_SKETCH_WIDTH)
+
+// Maximum number of tracked heavy hitters.
+#ifndef HEAVY_HITTER_MAX_K
+    #define HEAVY_HITTER_MAX_K 64
+#endif
+
+/** Count-min sketch with a top-K candidate list. Candidates are kept space saving style: when the list is full,
+ * a new key replaces the candidate with the smallest count if its estimate is larger. Memory is bounded by the sketch
+ * dimensions and K regardless of the number of keys. Not thread safe, every lcore should update its own sketch.
+ * */
+class HeavyHitterSketch {
+    public:
+        HeavyHitterSketch();
+
+        ~HeavyHitterSketch();
+
+        // Allocate the sketch on the given socket. @param top_k Number of candidates to keep, at most HEAVY_HITTER_MAX_K
+        bool initialize(unsigned int top_k, int socket_id);
+
+        void update(uint32_t key, uint64_t weight);
+
+        // Estimated total weight of the key. Never less than the real weight.
+        uint64_t estimate(uint32_t key) const;
+
+        // Estimate of the key from a counter array of another sketch or a sum of sketches.
+        static uint64_t estimate(const uint64_t *counters, uint32_t key);
+
+        // Add counters of this sketch to @param counters which has HEAVY_HITTER_SKETCH_COUNTERS entries.
+        void add_counters_to(uint64_t *counters) const;
+
+        void reset();
+
+        unsigned int get_candidate_count() const;
+
+        const uint32_t *get_candidate_keys() const;
+
+        uint64_t get_total_weight() const;
+
+    private:
+        uint64_t *counters;
+
+        unsigned int top_k;
+
+        unsigned int candidate_count;
+
+        uint32_t candidate_keys[HEAVY_HITTER_MAX_K];
+
+        uint64_t candidate_counts[HEAVY_HITTER_MAX_K];
+
+        // Index of the candidate with the smallest count. Only valid when the list is full.
+        unsigned int min_candidate;
+
+        uint64_t total_weight;
+
+        void find_min_candidate();
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "logger_clock.h"
+
+
+
+uint64_t TscClock::get_cycles(){
+    return rte_rdtsc();
+}
+
+uint64_t TscClock::get_hz(){
+    return rte_get_timer_hz();
+}
+
+
+VirtualClock::VirtualClock(uint64_t hz, uint64_t start_cycles) : hz(hz), cycles(start_cycles){
+
+}
+
+uint64_t VirtualClock::get_cycles(){
+    return __atomic_load_n(&cycles, __ATOMIC_ACQUIRE);
+}
+
+uint64_t VirtualClock::get_hz(){
+    return hz;
+}
+
+void VirtualClock::set_cycles(uint64_t new_cycles){
+    if(new_cycles > cycles){
+        __atomic_store_n(&cycles, new_cycles, __ATOMIC_RELEASE);
+    }
+}
+
+void VirtualClock::advance(uint64_t delta_cycles){
+    __atomic_store_n(&cycles, cycles + delta_cycles, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,51 @@
+#ifndef DPDK_LOGGER_CLOCK_H
+#define DPDK_LOGGER_CLOCK_H
+
+#include "rte_common.h"
+#include "rte_cycles.h"
+
+/** Time source of the logger. All timestamps and periods of the logger are read from a clock
+ * so that traces can be replayed and long runs can be simulated without waiting for real time.
+ * */
+class LoggerClock {
+    public:
+        LoggerClock(){}
+
+        virtual ~LoggerClock(){};
+
+        // Current time in cycles.
+        virtual uint64_t get_cycles() = 0;
+
+        // Number of cycles in one second.
+        virtual uint64_t get_hz() = 0;
+};
+
+// Real time from the TSC. This is the default clock.
+class TscClock : public LoggerClock {
+    public:
+        uint64_t get_cycles();
+
+        uint64_t get_hz();
+};
+
+// Clock that only moves when it is told to. Used for replaying traces and simulations.
+class VirtualClock : public LoggerClock {
+    public:
+        VirtualClock(uint64_t hz, uint64_t start_cycles = 0);
+
+        uint64_t get_cycles();
+
+        uint64_t get_hz();
+
+        // Move the clock to the given time. Clock never moves backwards.
+        void set_cycles(uint64_t new_cycles);
+
+        void advance(uint64_t delta_cycles);
+
+    private:
+        uint64_t hz;
+
+        uint64_t cycles;
+};
+
+#endif
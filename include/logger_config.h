@@ -16,6 +16,36 @@
     #define TIMER_RESOLUTION_CYCLES 10000000ULL // Around 5ms for 2Ghz
 #endif
 
+// Maximum number of DRB's. Sampled DRB statistics are published in arrays of this size.
+#ifndef MAX_DRB_COUNT
+    #define MAX_DRB_COUNT 1024
+#endif
+
+// Maximum number of periodic callbacks of a logger.
+#ifndef MAX_PERIOD_TASKS
+    #define MAX_PERIOD_TASKS 64
+#endif
+
+// Maximum number of service calls skipped between checks while a logger lcore has no measurements.
+#ifndef LOGGER_SERVICE_MAX_BACKOFF
+    #define LOGGER_SERVICE_MAX_BACKOFF 1024
+#endif
+
+// Size of the ring that secondary processes push events into. Must be a power of two.
+#ifndef LOGGER_EVENT_RING_SIZE
+    #define LOGGER_EVENT_RING_SIZE 16384
+#endif
+
+// Number of events dequeued from the event ring at once.
+#ifndef LOGGER_EVENT_BURST
+    #define LOGGER_EVENT_BURST 64
+#endif
+
+// Size of the ring that delivers triggered rule notifications. Must be a power of two.
+#ifndef TRIGGER_RING_SIZE
+    #define TRIGGER_RING_SIZE 1024
+#endif
+
 
 // Min Max Macros. These macros are not type safe.
 #define GENERIC_MAX(x, y) ((x) > (y) ? (x) : (y))
@@ -0,0 +1,38 @@
+#ifndef DPDK_LOGGER_EVENT_H
+#define DPDK_LOGGER_EVENT_H
+
+#include "rte_common.h"
+
+// Default name of the ring that secondary processes push events into. Primary creates it with create_event_ring.
+#define LOGGER_EVENT_RING_NAME "logger_events"
+
+// Event types
+// Arguments: SSB ID in id, PRACH type, count
+#define LOGGER_EVENT_PRACH 1U
+// Arguments: DRB ID in id, cell ID, count, new UE
+#define LOGGER_EVENT_ACTIVE_UE 2U
+// Arguments: DRB ID in id, cell ID, count, new UE
+#define LOGGER_EVENT_INACTIVE_UE 3U
+
+/** An event produced outside of the logger process. Events are written directly into the ring slots by the producers
+ * and folded into the measurements by the primary, so the layout is shared by both libraries. 16 bytes.
+ * */
+struct logger_event{
+
+    uint8_t type;
+
+    uint8_t prach_type;
+
+    uint8_t new_ue;
+
+    uint8_t reserved;
+
+    // SSB ID or DRB ID depending on the type
+    int32_t id;
+
+    int32_t cell_id;
+
+    uint32_t count;
+};
+
+#endif
@@ -1,7 +1,11 @@
 #include "logger_lib.h"
 #include "logger_config.h"
 #include <string>
+#include <algorithm>
 #include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+#include <rte_pause.h>
 
 #define FIRST_21_MASK  0x00000000001FFFFFUL
 #define SECOND_21_MASK 0x000003FFFFE00000UL
@@ -11,42 +15,516 @@
 #define LAST_32_MASK   0xFFFFFFFF00000000UL
 
 static void ssb_timer_callback(struct rte_timer *tim, void *arg){
-    LoggerLib *logger = (LoggerLib *)arg;
-    logger->per_ssb_timer_callback(tim, NULL);
+    sample_group *group = (sample_group *)arg;
+    group->logger->per_ssb_timer_callback(tim, group);
 }
 
 static void per_drb_per_cell_callback(struct rte_timer *tim, void *arg){
-    LoggerLib *logger = (LoggerLib *)arg;
-    logger->per_drb_per_cell_timer_callback(tim, NULL);
+    sample_group *group = (sample_group *)arg;
+    group->logger->per_drb_per_cell_timer_callback(tim, group);
 }
 
-LoggerLib::LoggerLib(int core_socket_id) : current_core_id(core_socket_id), ssb_first_available_id(-1){
-    rte_timer_subsystem_init();
+static int32_t logger_service_callback(void *arg){
+    logger_service *service = (logger_service *)arg;
+    return service->logger->service_callback(service);
+}
+
+static void socket_ssb_timer_callback(struct rte_timer *tim, void *arg){
+    sample_group_socket *group_socket = (sample_group_socket *)arg;
+    group_socket->group->logger->per_socket_ssb_timer_callback(tim, group_socket);
+}
+
+LoggerLib::LoggerLib(int core_socket_id) : current_core_id(rte_lcore_id()), multi_socket_mode(false), 
+                                            ssb_first_available_id(-1){
     rte_metrics_init(core_socket_id);
 
     metric_handler.initialize_metrics((void *) &core_socket_id);
+    initialize_state(core_socket_id);
+}
+
+LoggerLib::LoggerLib(const std::vector<unsigned int> &logger_lcore_ids) : current_core_id(-1), multi_socket_mode(true), 
+                                            lcore_shards(RTE_MAX_LCORE, NULL), ssb_first_available_id(-1){
+    if(logger_lcore_ids.empty()){
+        rte_panic("Multi socket logger needs at least one logger lcore\n");
+    }
+
+    current_core_id = logger_lcore_ids[0];
+
+    // Snapshots are written by the first logger lcore, keep them on its socket.
+    initialize_state(rte_lcore_to_socket_id(current_core_id));
+
+    for(unsigned int i = 0; i < logger_lcore_ids.size(); i++){
+        per_socket_shard *socket = new per_socket_shard();
+
+        socket->logger = this;
+        socket->socket_id = rte_lcore_to_socket_id(logger_lcore_ids[i]);
+        socket->logger_lcore_id = logger_lcore_ids[i];
+
+        for(unsigned int j = 0; j < 2; j++){
+            socket->ssb_period_values[j] = (uint64_t *) rte_zmalloc_socket("logger_ssb_period", sizeof(uint64_t) * SOCKET_METRIC_CAPACITY,
+                                                                            RTE_CACHE_LINE_SIZE, socket->socket_id);
+
+            if(socket->ssb_period_values[j] == NULL){
+                rte_panic("Cannot allocate SSB period values on socket %d\n", socket->socket_id);
+            }
+        }
+
+        socket_shards.push_back(socket);
+    }
+
+    unsigned int lcore_id;
+    RTE_LCORE_FOREACH(lcore_id){
+        int socket_id = rte_lcore_to_socket_id(lcore_id);
+        per_socket_shard *owner = NULL;
+
+        for(unsigned int i = 0; i < socket_shards.size(); i++){
+            if(socket_shards[i]->socket_id == socket_id){
+                owner = socket_shards[i];
+                break;
+            }
+        }
+
+        if(owner == NULL){
+            printf("Lcore %u on socket %d has no logger lcore, it will not be able to update metrics\n", lcore_id, socket_id);
+            continue;
+        }
+
+        SocketMetricInterface *shard = new SocketMetricInterface();
+
+        if(!shard->initialize_metrics((void *) &socket_id)){
+            rte_panic("Cannot initialize metric shard of lcore %u\n", lcore_id);
+        }
+
+        lcore_shards[lcore_id] = shard;
+        active_shards.push_back(shard);
+        owner->lcore_ids.push_back(lcore_id);
+
+        debug_print(LOG_OUTPUT_FILE, "Metric shard of lcore %u is allocated on socket %d\n", lcore_id, socket_id);
+    }
+}
+
+void LoggerLib::initialize_state(int socket_id){
+    rte_timer_subsystem_init();
+
+    period_task_count = 0;
+    task_generation = 0;
+
+    lcore_task_state empty_state;
+    memset(&empty_state, 0, sizeof(lcore_task_state));
+    empty_state.next_deadline = UINT64_MAX;
+    empty_state.jitter_last_metric_id = -1;
+    empty_state.jitter_max_metric_id = -1;
+    task_states.assign(RTE_MAX_LCORE, empty_state);
+
+    aggregate_kernel = select_packed_count_aggregate_kernel();
+    report_encoder = NULL;
+    clock = &tsc_clock;
+    trace_recorder = NULL;
+    heavy_hitter_top_k = 0;
+    heavy_hitter_period = 0;
+    last_ssb_group = NULL;
+    last_drb_group = NULL;
+    event_ring = NULL;
+    invalid_events = 0;
+
+    rte_spinlock_init(&registration_lock);
+    rte_spinlock_init(&ssb_publish_lock);
+    rte_spinlock_init(&rollup_lock);
+
+    initialize_triggers(socket_id);
+
+    if(!ssb_snapshot.initialize(SOCKET_METRIC_CAPACITY, socket_id) || !drb_snapshot.initialize(MAX_DRB_COUNT, socket_id)){
+        rte_panic("Cannot allocate logger snapshots on socket %d\n", socket_id);
+    }
 }
 
 LoggerLib::~LoggerLib(){
-    
+    // Services may be running on another lcore, wait until they are out of the callback before freeing anything.
+    for(unsigned int i = 0; i < services.size(); i++){
+        rte_service_component_runstate_set(services[i]->service_id, 0);
+
+        while(rte_service_may_be_active(services[i]->service_id) == 1){
+            rte_pause();
+        }
+
+        rte_service_component_unregister(services[i]->service_id);
+        delete services[i];
+    }
+
+    for(unsigned int i = 0; i < socket_shards.size(); i++){
+        rte_free(socket_shards[i]->ssb_period_values[0]);
+        rte_free(socket_shards[i]->ssb_period_values[1]);
+        delete socket_shards[i];
+    }
+
+    for(unsigned int i = 0; i < lcore_shards.size(); i++){
+        delete lcore_shards[i];
+    }
+
+    for(unsigned int i = 0; i < ssb_groups.size(); i++){
+        delete ssb_groups[i];
+    }
+
+    for(unsigned int i = 0; i < drb_groups.size(); i++){
+        delete drb_groups[i];
+    }
+
+    rte_ring_free(trigger_ring);
+    rte_ring_free(event_ring);
+
+    free_heavy_hitter_sketches();
+}
+
+void LoggerLib::free_heavy_hitter_sketches(){
+    for(unsigned int i = 0; i < heavy_hitter_sketches.size(); i++){
+        delete heavy_hitter_sketches[i];
+    }
+
+    heavy_hitter_sketches.clear();
+}
+
+
+MetricInterface *LoggerLib::current_lcore_shard(){
+    unsigned int lcore_id = rte_lcore_id();
+
+    if(lcore_id >= lcore_shards.size()){
+        return NULL;
+    }
+
+    return lcore_shards[lcore_id];
+}
+
+bool LoggerLib::register_metric(const char *metric_name, int &id){
+    if(!multi_socket_mode){
+        return metric_handler.register_metric(metric_name, id);
+    }
+
+    // Shards are registered in lockstep so the same ID is valid in every one of them.
+    bool registered = false;
+
+    for(unsigned int i = 0; i < lcore_shards.size(); i++){
+        if(lcore_shards[i] == NULL){
+            continue;
+        }
+
+        if(!lcore_shards[i]->register_metric(metric_name, id)){
+            return false;
+        }
+
+        registered = true;
+    }
+
+    return registered;
+}
+
+bool LoggerLib::read_metric(int metric_id, uint64_t &metric_value){
+    if(!multi_socket_mode){
+        return metric_handler.get_metric(metric_id, metric_value);
+    }
+
+    // Shards only hold the updates made by their own lcore. Sum of all the shards is the metric value.
+    metric_value = 0;
+
+    for(unsigned int i = 0; i < active_shards.size(); i++){
+        uint64_t shard_value;
+
+        if(!active_shards[i]->get_metric(metric_id, shard_value)){
+            return false;
+        }
+
+        metric_value += shard_value;
+    }
+
+    return true;
+}
+
+bool LoggerLib::add_to_metric(int metric_id, int64_t value){
+    if(!multi_socket_mode){
+        return metric_handler.update_metric(metric_id, value, false);
+    }
+
+    MetricInterface *shard = current_lcore_shard();
+
+    if(shard == NULL){
+        return false;
+    }
+
+    return shard->update_metric(metric_id, value, false);
 }
 
 
 void LoggerLib::LoggerTick(){
-    uint64_t cur_tsc = rte_rdtsc();
-	uint64_t diff_tsc = cur_tsc - prev_tsc;
+    unsigned int lcore_id = rte_lcore_id();
+
+    if(lcore_id >= RTE_MAX_LCORE){
+        return;
+    }
+
+    // Events are folded on every tick so that the ring does not fill between timer resolutions.
+    if(event_ring != NULL && lcore_id == (unsigned int) current_core_id){
+        drain_event_ring();
+    }
+
+    lcore_task_state &state = task_states[lcore_id];
+    uint64_t cur_tsc = clock->get_cycles();
+	uint64_t diff_tsc = cur_tsc - state.prev_tsc;
 	
+    // Timers of the application are still run with the timer resolution.
     if (diff_tsc > TIMER_RESOLUTION_CYCLES) {
 		rte_timer_manage();
-		prev_tsc = cur_tsc;
+		state.prev_tsc = cur_tsc;
 	}
+
+    // Logger periods are run as soon as their deadline passes, this is a single compare until then.
+    poll_period_tasks(lcore_id, cur_tsc);
+}
+
+bool LoggerLib::poll_period_tasks(unsigned int lcore_id, uint64_t now){
+    lcore_task_state &state = task_states[lcore_id];
+    uint32_t generation = __atomic_load_n(&task_generation, __ATOMIC_ACQUIRE);
+
+    if(generation == state.generation && now < state.next_deadline){
+        return false;
+    }
+
+    state.generation = generation;
+    run_period_tasks(lcore_id, now);
+
+    return true;
+}
+
+bool LoggerLib::schedule_period_task(int &task_id, uint64_t period_cycles, unsigned int lcore_id, rte_timer_cb_t callback, void *arg){
+    if(period_cycles == 0){
+        printf("Period of a task can not be zero\n");
+        return false;
+    }
+
+    if(period_task_count == MAX_PERIOD_TASKS){
+        printf("Maximum period task count %d is reached\n", MAX_PERIOD_TASKS);
+        return false;
+    }
+
+    logger_period_task &task = period_tasks[period_task_count];
+
+    task.period_cycles = period_cycles;
+    task.next_deadline = clock->get_cycles() + period_cycles;
+    task.lcore_id = lcore_id;
+    task.callback = callback;
+    task.arg = arg;
+
+    task_id = period_task_count;
+    __atomic_store_n(&period_task_count, period_task_count + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&task_generation, 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+void LoggerLib::run_period_tasks(unsigned int lcore_id, uint64_t now){
+    lcore_task_state &state = task_states[lcore_id];
+    uint32_t task_count = __atomic_load_n(&period_task_count, __ATOMIC_ACQUIRE);
+    uint64_t next_deadline = UINT64_MAX;
+
+    for(uint32_t i = 0; i < task_count; i++){
+        logger_period_task &task = period_tasks[i];
+
+        if(task.lcore_id != lcore_id){
+            continue;
+        }
+
+        if(now >= task.next_deadline){
+            record_period_jitter(state, now - task.next_deadline);
+            task.callback(NULL, task.arg);
+
+            // Deadlines stay on the same grid. If the lcore stalled for more than a period, missed periods are skipped.
+            task.next_deadline += task.period_cycles;
+
+            if(task.next_deadline <= now){
+                task.next_deadline += ((now - task.next_deadline) / task.period_cycles + 1) * task.period_cycles;
+            }
+        }
+
+        next_deadline = GENERIC_MIN(next_deadline, task.next_deadline);
+    }
+
+    state.next_deadline = next_deadline;
+}
+
+void LoggerLib::record_period_jitter(lcore_task_state &state, uint64_t jitter_cycles){
+    __atomic_store_n(&state.last_jitter_cycles, jitter_cycles, __ATOMIC_RELAXED);
+
+    if(jitter_cycles > state.max_jitter_cycles){
+        __atomic_store_n(&state.max_jitter_cycles, jitter_cycles, __ATOMIC_RELAXED);
+    }
+
+    if(__atomic_load_n(&state.jitter_last_metric_id, __ATOMIC_ACQUIRE) < 0){
+        return;
+    }
+
+    // Services may move between service lcores, so metrics are updated with differences that add up across shards.
+    uint64_t last_ns = (double) state.last_jitter_cycles * 1E9 / clock->get_hz();
+    uint64_t max_ns = (double) state.max_jitter_cycles * 1E9 / clock->get_hz();
+
+    if(last_ns != state.reported_last_jitter_ns){
+        add_to_metric(state.jitter_last_metric_id, (int64_t) (last_ns - state.reported_last_jitter_ns));
+        state.reported_last_jitter_ns = last_ns;
+    }
+
+    if(max_ns != state.reported_max_jitter_ns){
+        add_to_metric(state.jitter_max_metric_id, (int64_t) (max_ns - state.reported_max_jitter_ns));
+        state.reported_max_jitter_ns = max_ns;
+    }
+}
+
+bool LoggerLib::register_services(std::vector<uint32_t> &service_ids){
+    std::vector<unsigned int> logger_lcores;
+
+    if(!services.empty()){
+        printf("Logger services are already registered\n");
+        return false;
+    }
+
+    if(multi_socket_mode){
+        for(unsigned int i = 0; i < socket_shards.size(); i++){
+            logger_lcores.push_back(socket_shards[i]->logger_lcore_id);
+        }
+    }else{
+        logger_lcores.push_back(current_core_id);
+    }
+
+    service_ids.clear();
+
+    for(unsigned int i = 0; i < logger_lcores.size(); i++){
+        unsigned int lcore_id = logger_lcores[i];
+        lcore_task_state &state = task_states[lcore_id];
+        std::string last_name = "logger_jitter_last_ns_" + std::to_string(lcore_id);
+        std::string max_name = "logger_jitter_max_ns_" + std::to_string(lcore_id);
+        int last_metric_id;
+        int max_metric_id;
+
+        if(!register_metric(last_name.c_str(), last_metric_id) || !register_metric(max_name.c_str(), max_metric_id)){
+            printf("Cannot register jitter metrics of lcore %u\n", lcore_id);
+            return false;
+        }
+
+        // Jitter is exported once the last metric ID is set, so it is written after the max.
+        state.jitter_max_metric_id = max_metric_id;
+        __atomic_store_n(&state.jitter_last_metric_id, last_metric_id, __ATOMIC_RELEASE);
+
+        logger_service *service = new logger_service();
+        struct rte_service_spec spec;
+
+        service->logger = this;
+        service->lcore_id = lcore_id;
+        service->idle_skip = 0;
+        service->backoff = 1;
+
+        memset(&spec, 0, sizeof(spec));
+        snprintf(spec.name, sizeof(spec.name), "logger_%u", lcore_id);
+        spec.callback = logger_service_callback;
+        spec.callback_userdata = service;
+        spec.socket_id = rte_lcore_to_socket_id(lcore_id);
+
+        // Tasks of an lcore are not thread safe, so the service is not marked MT safe and runs on one lcore at a time.
+        if(rte_service_component_register(&spec, &service->service_id) != 0){
+            printf("Cannot register logger service %s\n", spec.name);
+            delete service;
+            return false;
+        }
+
+        rte_service_component_runstate_set(service->service_id, 1);
+        services.push_back(service);
+        service_ids.push_back(service->service_id);
+
+        debug_print(LOG_OUTPUT_FILE, "Logger service %s has been registered with ID %u\n", spec.name, service->service_id);
+    }
+
+    return true;
+}
+
+int32_t LoggerLib::service_callback(void *arg){
+    logger_service *service = (logger_service *)arg;
+    lcore_task_state &state = task_states[service->lcore_id];
+    bool drains_events = event_ring != NULL && service->lcore_id == (unsigned int) current_core_id;
+
+    // Nothing is measured on this lcore yet. Checks get exponentially rarer until something is added.
+    if(service->idle_skip > 0){
+        service->idle_skip--;
+        return -EAGAIN;
+    }
+
+    unsigned int drained = drains_events ? drain_event_ring() : 0;
+    bool checked = poll_period_tasks(service->lcore_id, clock->get_cycles());
+
+    if(state.next_deadline == UINT64_MAX && !drains_events){
+        service->idle_skip = service->backoff;
+        service->backoff = GENERIC_MIN(service->backoff * 2, LOGGER_SERVICE_MAX_BACKOFF);
+        return -EAGAIN;
+    }
+
+    service->backoff = 1;
+    return (checked || drained > 0) ? 0 : -EAGAIN;
 }
 
-bool LoggerLib::add_new_ssb(int &id){
+bool LoggerLib::get_period_jitter(unsigned int lcore_id, uint64_t &last_jitter_ns, uint64_t &max_jitter_ns){
+    if(lcore_id >= task_states.size()){
+        return false;
+    }
+
+    lcore_task_state &state = task_states[lcore_id];
+
+    last_jitter_ns = (double) __atomic_load_n(&state.last_jitter_cycles, __ATOMIC_RELAXED) * 1E9 / clock->get_hz();
+    max_jitter_ns = (double) __atomic_load_n(&state.max_jitter_cycles, __ATOMIC_RELAXED) * 1E9 / clock->get_hz();
+
+    return true;
+}
+
+int64_t LoggerLib::run_simulation_until(uint64_t target_cycles){
+    VirtualClock *virtual_clock = dynamic_cast<VirtualClock *>(clock);
+    int64_t callback_count = 0;
+
+    if(virtual_clock == NULL){
+        printf("Simulation needs a virtual clock\n");
+        return -1;
+    }
+
+    while(true){
+        uint32_t task_count = __atomic_load_n(&period_task_count, __ATOMIC_ACQUIRE);
+        int next_task = -1;
+
+        // Earliest deadline first, ties are broken by task order so that runs are deterministic.
+        for(uint32_t i = 0; i < task_count; i++){
+            if(next_task < 0 || period_tasks[i].next_deadline < period_tasks[next_task].next_deadline){
+                next_task = i;
+            }
+        }
+
+        if(next_task < 0 || period_tasks[next_task].next_deadline > target_cycles){
+            break;
+        }
+
+        logger_period_task &task = period_tasks[next_task];
+
+        virtual_clock->set_cycles(task.next_deadline);
+        task.next_deadline += task.period_cycles;
+        task.callback(NULL, task.arg);
+
+        callback_count++;
+    }
+
+    virtual_clock->set_cycles(target_cycles);
+    return callback_count;
+}
+
+bool LoggerLib::add_new_ssb(int &id, uint32_t sample_period_ms){
     // if(ssb_first_available_id == TOTAL_SSB_COUNT - 1){
     //     return false;
     // }
 
+    if(sample_period_ms == 0){
+        printf("Sample period of an SSB can not be zero\n");
+        return false;
+    }
+
     ssb_first_available_id++;
 
     std::string str;
@@ -54,17 +532,35 @@ bool LoggerLib::add_new_ssb(int &id){
     str += "per_ssb_log_";
     str += std::to_string(ssb_first_available_id);
 
-    if(metric_handler.register_metric(str.c_str(), id) == true){
-        per_ssb_data.insert(std::make_pair(id, empty_ssb_measurements));
+    if(register_metric(str.c_str(), id) == true){
+        rte_spinlock_lock(&registration_lock);
 
-        // We received our first SSB Callback. We need to start the Timer callbacks
-        if(ssb_first_available_id == 0){
-            debug_print(LOG_OUTPUT_FILE, "Adding A New SSB Timer for core %d\n", current_core_id);
+        // SSB's with the same period share a group. Groups start their timers when they are created.
+        sample_group *group = get_sample_group(SAMPLE_GROUP_SSB, clock->get_hz() * sample_period_ms / 1000);
 
-            rte_timer_reset(&per_ssb_timer, rte_get_timer_hz(), PERIODICAL, current_core_id, ssb_timer_callback, this);
+        if(group == NULL){
+            rte_spinlock_unlock(&registration_lock);
+            printf("SSB Device Registration has failed, no period task is available.\n");
+            ssb_first_available_id--;
+            return false;
         }
+
+        per_ssb_state state;
+        state.measurements = empty_ssb_measurements;
+        state.sample_period_ms = sample_period_ms;
+        state.group = group;
+
+        per_ssb_data.insert(std::make_pair(id, state));
+        group->ids.push_back(id);
+
+        rte_spinlock_unlock(&registration_lock);
         
         debug_print(LOG_OUTPUT_FILE, "A new SSB Device Has been created with ID: %d\n", id);
+
+        if(trace_recorder != NULL){
+            int64_t args[2] = {sample_period_ms, id};
+            trace_recorder->record(TRACE_ADD_SSB, clock->get_cycles(), args, 2);
+        }
         
     }else{
         printf("SSB Device Registration has failed.\n");
@@ -77,26 +573,148 @@ bool LoggerLib::add_new_ssb(int &id){
     return true;
 }
 
+sample_group *LoggerLib::get_sample_group(uint8_t kind, uint64_t period_cycles){
+    std::vector<sample_group *> &groups = kind == SAMPLE_GROUP_SSB ? ssb_groups : drb_groups;
+
+    for(unsigned int i = 0; i < groups.size(); i++){
+        if(groups[i]->period_cycles == period_cycles){
+            return groups[i];
+        }
+    }
+
+    unsigned int task_count = (kind == SAMPLE_GROUP_SSB && multi_socket_mode) ? socket_shards.size() : 1;
+
+    if(period_cycles == 0 || period_task_count + task_count > MAX_PERIOD_TASKS){
+        printf("Cannot create a sample group with period of %" PRIu64 " cycles\n", period_cycles);
+        return NULL;
+    }
+
+    // Task count is checked above, so scheduling the tasks of the group can not fail.
+    sample_group *group = new sample_group();
+
+    group->logger = this;
+    group->kind = kind;
+    group->index = groups.size();
+    group->period_cycles = period_cycles;
+    group->task_id = -1;
+    group->claimed_period = 0;
+    group->published_period = 0;
+
+    groups.push_back(group);
+
+    if(kind == SAMPLE_GROUP_DRB){
+        // Per DRB per cell sampling always runs on the first logger lcore.
+        schedule_period_task(group->task_id, period_cycles, current_core_id, per_drb_per_cell_callback, group);
+    }else if(!multi_socket_mode){
+        debug_print(LOG_OUTPUT_FILE, "Adding A New SSB Timer for core %d\n", current_core_id);
+
+        schedule_period_task(group->task_id, period_cycles, current_core_id, ssb_timer_callback, group);
+    }else{
+        // Every socket drains its own shards on its own logger lcore. Sockets are fixed, so the part addresses are stable.
+        group->sockets.resize(socket_shards.size());
+
+        for(unsigned int i = 0; i < socket_shards.size(); i++){
+            debug_print(LOG_OUTPUT_FILE, "Adding A New SSB Timer for socket %d on core %u\n", 
+                            socket_shards[i]->socket_id, socket_shards[i]->logger_lcore_id);
+
+            group->sockets[i].group = group;
+            group->sockets[i].socket = socket_shards[i];
+            group->sockets[i].task_id = -1;
+            group->sockets[i].drained_period = 0;
+
+            schedule_period_task(group->sockets[i].task_id, period_cycles, socket_shards[i]->logger_lcore_id, 
+                                    socket_ssb_timer_callback, &group->sockets[i]);
+        }
+    }
+
+    return group;
+}
+
 bool LoggerLib::update_metric_value(int metric_id, int64_t value, bool absolute){
-    return metric_handler.update_metric(metric_id, value, absolute);
+    if(!multi_socket_mode){
+        return metric_handler.update_metric(metric_id, value, absolute);
+    }
+
+    MetricInterface *shard = current_lcore_shard();
+
+    if(shard == NULL){
+        return false;
+    }
+
+    if(!shard->update_metric(metric_id, value, absolute)){
+        return false;
+    }
+
+    // Metric value is the sum of the shards. Other shards are cleared so that the sum is the value that is set.
+    if(absolute){
+        uint64_t shard_value;
+
+        for(unsigned int i = 0; i < active_shards.size(); i++){
+            if(active_shards[i] != shard){
+                active_shards[i]->get_and_reset_metric(metric_id, shard_value);
+            }
+        }
+    }
+
+    return true;
 }
 
 // Each SSB Has three possible PRACH. Instead of preserving a metric for each one,
 // values will be decoded into 64bit integer. So maximum value of the PRACH will be
-// 21 bits. After That, values would overflow.
+// 21 bits. After That, values would overflow. Count is shifted into its field and added to
+// the metric so that the update is a single relative write.
 bool LoggerLib::on_ssb_prach_receive(int id, uint8_t type, uint32_t count){
+    bool result;
+
+    switch (type)
+    {
+    
+    // First 21 is for PRACH_DEDICATED Messages
+    case PRACH_DEDICATED:
+        result = add_to_metric(id, (uint64_t) count);
+        break;
+
+    // Middle 21 bits are for PRACH_HIGH
+    case PRACH_RAND_HIGH:
+        result = add_to_metric(id, ((uint64_t) count) << 21);
+        break;
+
+    // Remaining bits are for PRACH_RAND_LOW
+    case PRACH_RAND_LOW:
+        result = add_to_metric(id, ((uint64_t) count) << 42);
+        break;
+    
+    default:
+        return false;
+    }
+
+    if(result && heavy_hitter_top_k > 0){
+        update_heavy_hitters(HEAVY_HITTER_SSB_PRACH, id, count);
+    }
+
+    if(trace_recorder != NULL){
+        int64_t args[3] = {id, type, count};
+        trace_recorder->record(TRACE_PRACH, clock->get_cycles(), args, 3);
+    }
+
+    return result;
+}
+
+
+
+int LoggerLib::get_ssb_message_count(int ssb_id, uint8_t prach_type){
     uint64_t current_ssb_prach; 
-    bool result = metric_handler.get_metric(id, current_ssb_prach);
+    bool result = read_metric(ssb_id, current_ssb_prach);
 
-    // debug_print(LOG_OUTPUT_FILE,"Current SSB Prach Metric ID is %d and its value is %d\n", id, current_ssb_prach);
+    // debug_print(LOG_OUTPUT_FILE,"Current SSB Prach Metric ID is %d and its value is %d\n", ssb_id, current_ssb_prach);
 
     if(!result){
-        return false;
+        return -1;
     }
 
     uint64_t mask;
 
-    switch (type)
+    switch (prach_type)
     {
     
     // First 21 is for PRACH_DEDICATED Messages
@@ -104,15 +722,7 @@ bool LoggerLib::on_ssb_prach_receive(int id, uint8_t type, uint32_t count){
         mask = FIRST_21_MASK;
         uint64_t result = current_ssb_prach & mask;
 
-        
-
-        result += count;
-        // debug_print(LOG_OUTPUT_FILE,"Current SSB Dedicated Count is %d\n", result);
-        current_ssb_prach &= (~mask);
-
-        current_ssb_prach += result;
-
-        return metric_handler.update_metric(id, current_ssb_prach, true);
+        return result;
     }
 
     // Middle 21 bits are for PRACH_HIGH
@@ -121,17 +731,8 @@ bool LoggerLib::on_ssb_prach_receive(int id, uint8_t type, uint32_t count){
         uint64_t result = current_ssb_prach & mask;
 
         result >>= 21;
-        result += count;
-
-        // debug_print(LOG_OUTPUT_FILE,"Current SSB Rand HIGH Count is %d\n", result);
-
-
-        result <<= 21;
 
-        current_ssb_prach &= (~mask);
-        current_ssb_prach += (result);
-
-        return metric_handler.update_metric(id, current_ssb_prach, true);
+        return result;
     }
 
     // Remaining bits are for PRACH_RAND_LOW
@@ -140,117 +741,529 @@ bool LoggerLib::on_ssb_prach_receive(int id, uint8_t type, uint32_t count){
         uint64_t result = current_ssb_prach & mask;
 
         result >>= 42;
-        result += count;
 
-        // debug_print(LOG_OUTPUT_FILE,"Current SSB Rand LOW Count is %d\n", result);
+        return result;
+    }
 
+    default:
+        return -1;
+    }
+}
 
-        result <<= 42;
 
-        current_ssb_prach &= (uint64_t)(~mask);
-        current_ssb_prach += (result);
 
-        return metric_handler.update_metric(id, current_ssb_prach, true);
-    }
+// Index of the PRACH type in per_ssb_measurements values. -1 if the type is not valid.
+static int ssb_value_index(uint8_t prach_type){
+    switch (prach_type)
+    {
+    case PRACH_DEDICATED:
+        return 0;
+
+    case PRACH_RAND_HIGH:
+        return 1;
+
+    case PRACH_RAND_LOW:
+        return 2;
 
-        
-    
     default:
+        return -1;
+    }
+}
+
+int LoggerLib::get_ssb_message_frequency(int ssb_id, uint8_t prach_type){
+    per_ssb_measurements measurements;
+    int index = ssb_value_index(prach_type);
+
+    if(index < 0 || !get_ssb_measurements(ssb_id, measurements)){
+        return -1;
+    }
+
+    return measurements.values[index];
+}
+
+bool LoggerLib::get_ssb_measurements(int ssb_id, per_ssb_measurements &measurements){
+    if(ssb_id < 0){
         return false;
     }
+
+    // Snapshot is written for every registered SSB in each period. An SSB registered after the last period reads zeros.
+    return ssb_snapshot.read(ssb_id, measurements);
 }
 
+bool LoggerLib::get_drb_ue_statistics(int drb_id, per_drb_statistics &statistics){
+    if(drb_id < 0){
+        return false;
+    }
 
+    return drb_snapshot.read(drb_id, statistics);
+}
 
-int LoggerLib::get_ssb_message_count(int ssb_id, uint8_t prach_type){
-    uint64_t current_ssb_prach; 
-    bool result = metric_handler.get_metric(ssb_id, current_ssb_prach);
 
-    // debug_print(LOG_OUTPUT_FILE,"Current SSB Prach Metric ID is %d and its value is %d\n", ssb_id, current_ssb_prach);
+void LoggerLib::publish_ssb_period(int ssb_id, per_ssb_measurements &measurements, uint64_t packed_value){
+    measurements.values[0] = packed_value & FIRST_21_MASK;
+    measurements.values[1] = (packed_value & SECOND_21_MASK) >> 21;
+    measurements.values[2] = (packed_value & THIRD_21_MASK) >> 42;
+
+    debug_print(LOG_OUTPUT_FILE,"Per SSB Values ID: %d, PRACH_DEDICATED %d, PRACH_RAND_HIGH %d, PRACH_RAND_LOW %d\n", 
+                        ssb_id, measurements.values[0], measurements.values[1], measurements.values[2]);
+
+    if(report_encoder != NULL){
+        int64_t fields[3] = {measurements.values[0], measurements.values[1], measurements.values[2]};
+        report_encoder->add_entry(ssb_id, fields);
+    }
+}
+
+void LoggerLib::set_report_encoder(ReportEncoder *encoder){
+    report_encoder = encoder;
+}
+
+void LoggerLib::set_clock(LoggerClock *new_clock){
+    clock = new_clock != NULL ? new_clock : &tsc_clock;
+}
+
+void LoggerLib::set_trace_recorder(TraceRecorder *recorder){
+    trace_recorder = recorder;
+}
+
+
+bool LoggerLib::run_sample_group(uint8_t kind, unsigned int index){
+    if(kind == SAMPLE_GROUP_SSB && index < ssb_groups.size()){
+        per_ssb_timer_callback(NULL, ssb_groups[index]);
+        return true;
+    }
+
+    if(kind == SAMPLE_GROUP_DRB && index < drb_groups.size()){
+        per_drb_per_cell_timer_callback(NULL, drb_groups[index]);
+        return true;
+    }
+
+    printf("Sample group %u of kind %u is not found\n", index, kind);
+    return false;
+}
+
+void LoggerLib::per_ssb_timer_callback(__rte_unused struct rte_timer *tim, void *arg){
+    //debug_print(LOG_OUTPUT_FILE,"Per SSB Timer Callback\n", NULL);
+    sample_group *group = (sample_group *)arg;
+
+    if(group == NULL){
+        rte_spinlock_lock(&registration_lock);
+        group = ssb_groups.empty() ? NULL : ssb_groups[0];
+        rte_spinlock_unlock(&registration_lock);
+
+        if(group == NULL){
+            return;
+        }
+    }
+
+    publish_ssb_group(group, 0);
+}
+
+
+void LoggerLib::per_socket_ssb_timer_callback(__rte_unused struct rte_timer *tim, void *arg){
+    sample_group_socket *group_socket = (sample_group_socket *)arg;
+    sample_group *group = group_socket->group;
+    per_socket_shard *socket = group_socket->socket;
+    uint64_t period = group_socket->drained_period + 1;
+
+    // Buffer of this period still holds the period before the last one until it is published. If another socket
+    // stalled that long, counts stay in the shards and are drained with the next period of this socket.
+    if(period > __atomic_load_n(&group->published_period, __ATOMIC_ACQUIRE) + 2){
+        return;
+    }
+
+    uint64_t *period_values = socket->ssb_period_values[period & 1];
+
+    rte_spinlock_lock(&registration_lock);
+
+    // Drain the shards of this socket. All of these reads are local to the socket.
+    for(unsigned int i = 0; i < group->ids.size(); i++){
+        int ssb_id = group->ids[i];
+        uint64_t total_value = 0;
+        uint64_t shard_value;
+
+        for(unsigned int j = 0; j < socket->lcore_ids.size(); j++){
+            if(lcore_shards[socket->lcore_ids[j]]->get_and_reset_metric(ssb_id, shard_value)){
+                total_value += shard_value;
+            }
+        }
+
+        period_values[ssb_id] = total_value;
+    }
+
+    rte_spinlock_unlock(&registration_lock);
+
+    __atomic_store_n(&group_socket->drained_period, period, __ATOMIC_SEQ_CST);
+
+    // Publish every period that all sockets have drained, in order. A socket that loses the claim has either seen
+    // the period published or left it to the claiming socket, which checks the next period after publishing.
+    while(true){
+        uint64_t next_period = __atomic_load_n(&group->published_period, __ATOMIC_SEQ_CST) + 1;
+        uint64_t claimed = next_period - 1;
+
+        for(unsigned int i = 0; i < group->sockets.size(); i++){
+            if(__atomic_load_n(&group->sockets[i].drained_period, __ATOMIC_SEQ_CST) < next_period){
+                return;
+            }
+        }
+
+        if(!__atomic_compare_exchange_n(&group->claimed_period, &claimed, next_period, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)){
+            return;
+        }
+
+        publish_ssb_group(group, next_period);
+
+        __atomic_store_n(&group->published_period, next_period, __ATOMIC_SEQ_CST);
+    }
+}
+
+void LoggerLib::publish_ssb_group(sample_group *group, uint64_t socket_period){
+    std::vector<std::pair<int, measurement_rollup> > completed_rollups;
+    uint64_t timestamp = clock->get_cycles();
+
+    rte_spinlock_lock(&registration_lock);
+    rte_spinlock_lock(&ssb_publish_lock);
+
+    per_ssb_measurements *snapshot = ssb_snapshot.begin_write();
+    uint64_t period = ssb_snapshot.published_periods() + 1;
+
+    // Only this group is sampled. SSB's published by another group in the last period are carried to this buffer.
+    if(last_ssb_group != NULL && last_ssb_group != group){
+        for(unsigned int i = 0; i < last_ssb_group->ids.size(); i++){
+            ssb_snapshot.carry_forward(last_ssb_group->ids[i]);
+        }
+    }
+
+    if(trace_recorder != NULL){
+        int64_t args[1] = {group->index};
+        trace_recorder->record(TRACE_SSB_PERIOD, timestamp, args, 1);
+    }
+
+    if(report_encoder != NULL){
+        report_encoder->begin_record(REPORT_RECORD_SSB, period, 3);
+    }
+
+    rte_spinlock_lock(&rollup_lock);
+
+    for(unsigned int i = 0; i < group->ids.size(); i++){
+        int ssb_id = group->ids[i];
+        uint64_t packed_value = 0;
+
+        if(multi_socket_mode){
+            for(unsigned int j = 0; j < socket_shards.size(); j++){
+                packed_value += socket_shards[j]->ssb_period_values[socket_period & 1][ssb_id];
+            }
+        }else if(!metric_handler.get_and_reset_metric(ssb_id, packed_value)){
+            packed_value = 0;
+        }
+
+        per_ssb_state &state = per_ssb_data[ssb_id];
+
+        publish_ssb_period(ssb_id, snapshot[ssb_id], packed_value);
+        state.measurements = snapshot[ssb_id];
+
+        if(!state.rollups.empty()){
+            uint64_t values[3] = {(uint64_t) state.measurements.values[0], (uint64_t) state.measurements.values[1], 
+                                    (uint64_t) state.measurements.values[2]};
+            update_rollups(state.rollups, ssb_id, values, timestamp, completed_rollups);
+        }
+    }
+
+    rte_spinlock_unlock(&rollup_lock);
+
+    if(report_encoder != NULL){
+        report_encoder->end_record();
+    }
+
+    evaluate_ssb_triggers(snapshot, group);
+    ssb_snapshot.end_write();
+    last_ssb_group = group;
+
+    rte_spinlock_unlock(&ssb_publish_lock);
+    rte_spinlock_unlock(&registration_lock);
+
+    report_rollups(REPORT_RECORD_SSB_ROLLUP, period, 3, completed_rollups);
+
+    // Sketches are rotated with the first group so that the heavy hitter period does not depend on the other groups.
+    if(heavy_hitter_top_k > 0 && group->index == 0){
+        rotate_heavy_hitters();
+    }
+}
+
+void LoggerLib::update_rollups(std::vector<rollup_resolution> &rollups, int id, const uint64_t *values, uint64_t timestamp,
+                                std::vector<std::pair<int, measurement_rollup> > &completed){
+    for(unsigned int i = 0; i < rollups.size(); i++){
+        if(add_rollup_sample(rollups[i], values, timestamp)){
+            // Every reporting period of a measurement gets its own entry ID in the report.
+            completed.push_back(std::make_pair(id * ROLLUP_MAX_RESOLUTIONS + i, rollups[i].last));
+        }
+    }
+}
+
+void LoggerLib::report_rollups(uint8_t record_type, uint64_t period, uint8_t value_count, 
+                                const std::vector<std::pair<int, measurement_rollup> > &completed){
+    if(report_encoder == NULL || completed.empty()){
+        return;
+    }
+
+    report_encoder->begin_record(record_type, period, 2 + value_count * 3);
+
+    for(unsigned int i = 0; i < completed.size(); i++){
+        const measurement_rollup &rollup = completed[i].second;
+        int64_t fields[2 + ROLLUP_MAX_VALUES * 3];
+
+        fields[0] = rollup.period_ms;
+        fields[1] = rollup.sample_count;
+
+        for(unsigned int j = 0; j < value_count; j++){
+            fields[2 + j * 3] = rollup.min[j];
+            fields[3 + j * 3] = rollup.max[j];
+            fields[4 + j * 3] = rollup.sum[j];
+        }
+
+        report_encoder->add_entry(completed[i].first, fields);
+    }
+
+    report_encoder->end_record();
+}
+
+
+bool LoggerLib::add_reporting_period(uint8_t source, int id, uint32_t period_ms){
+    std::vector<rollup_resolution> *rollups;
+    uint32_t samples_per_window;
+    uint8_t value_count;
+
+    if(source == ROLLUP_SOURCE_SSB){
+        std::map<int, per_ssb_state>::iterator it = per_ssb_data.find(id);
+
+        if(it == per_ssb_data.end()){
+            printf("SSB with ID %d is not found\n", id);
+            return false;
+        }
+
+        if(period_ms == 0 || period_ms % it->second.sample_period_ms != 0){
+            printf("Reporting period %u ms is not a multiple of the sample period %u ms\n", period_ms, it->second.sample_period_ms);
+            return false;
+        }
+
+        rollups = &it->second.rollups;
+        samples_per_window = period_ms / it->second.sample_period_ms;
+        value_count = 3;
+    }else if(source == ROLLUP_SOURCE_DRB){
+        std::map<int, per_drb_measurements>::iterator it = drb_measurement_map.find(id);
+
+        if(it == drb_measurement_map.end()){
+            printf("DRB with ID %d is not found\n", id);
+            return false;
+        }
+
+        uint64_t samples = (uint64_t) period_ms * it->second.ue_sampling_frequency;
+
+        if(samples == 0 || samples % 1000 != 0){
+            printf("Reporting period %u ms is not a multiple of the sample period of %d Hz\n", period_ms, it->second.ue_sampling_frequency);
+            return false;
+        }
+
+        rollups = &it->second.rollups;
+        samples_per_window = samples / 1000;
+        value_count = 2;
+    }else{
+        printf("Rollup source %u is not valid\n", source);
+        return false;
+    }
+
+    rte_spinlock_lock(&rollup_lock);
+
+    for(unsigned int i = 0; i < rollups->size(); i++){
+        if((*rollups)[i].current.period_ms == period_ms){
+            rte_spinlock_unlock(&rollup_lock);
+            printf("Reporting period %u ms is already registered\n", period_ms);
+            return false;
+        }
+    }
+
+    if(rollups->size() == ROLLUP_MAX_RESOLUTIONS){
+        rte_spinlock_unlock(&rollup_lock);
+        printf("Maximum reporting period count %d is reached\n", ROLLUP_MAX_RESOLUTIONS);
+        return false;
+    }
+
+    rollup_resolution resolution;
+    initialize_rollup(resolution, period_ms, samples_per_window, value_count);
+    rollups->push_back(resolution);
+
+    rte_spinlock_unlock(&rollup_lock);
+
+    if(trace_recorder != NULL){
+        int64_t args[3] = {source, id, period_ms};
+        trace_recorder->record(TRACE_ADD_ROLLUP, clock->get_cycles(), args, 3);
+    }
+
+    return true;
+}
+
+bool LoggerLib::get_rollup(uint8_t source, int id, uint32_t period_ms, measurement_rollup &rollup){
+    bool found = false;
+
+    rte_spinlock_lock(&registration_lock);
+    rte_spinlock_lock(&rollup_lock);
+
+    std::vector<rollup_resolution> *rollups = NULL;
+
+    if(source == ROLLUP_SOURCE_SSB){
+        std::map<int, per_ssb_state>::iterator it = per_ssb_data.find(id);
+        rollups = it != per_ssb_data.end() ? &it->second.rollups : NULL;
+    }else if(source == ROLLUP_SOURCE_DRB){
+        std::map<int, per_drb_measurements>::iterator it = drb_measurement_map.find(id);
+        rollups = it != drb_measurement_map.end() ? &it->second.rollups : NULL;
+    }
+
+    for(unsigned int i = 0; rollups != NULL && i < rollups->size(); i++){
+        if((*rollups)[i].current.period_ms == period_ms && (*rollups)[i].has_last){
+            rollup = (*rollups)[i].last;
+            found = true;
+            break;
+        }
+    }
+
+    rte_spinlock_unlock(&rollup_lock);
+    rte_spinlock_unlock(&registration_lock);
+
+    return found;
+}
+
+
+void LoggerLib::per_drb_per_cell_timer_callback(__rte_unused struct rte_timer *tim, void *arg){
+    debug_print(LOG_OUTPUT_FILE, "Per DRB Per Cell Timer Callback\n", NULL);
+    std::map<int, per_drb_measurements>::iterator it;
+    sample_group *group = (sample_group *)arg;
+
+    rte_spinlock_lock(&registration_lock);
 
-    if(!result){
-        return -1;
-    }
+    if(group == NULL){
+        if(drb_groups.empty()){
+            rte_spinlock_unlock(&registration_lock);
+            return;
+        }
 
-    uint64_t mask;
+        group = drb_groups[0];
+    }
 
-    switch (prach_type)
-    {
-    
-    // First 21 is for PRACH_DEDICATED Messages
-    case PRACH_DEDICATED: {
-        mask = FIRST_21_MASK;
-        uint64_t result = current_ssb_prach & mask;
+    std::vector<std::pair<int, measurement_rollup> > completed_rollups;
+    uint64_t timestamp = clock->get_cycles();
+    unsigned int cell_index = 0;
+    per_drb_statistics *snapshot = drb_snapshot.begin_write();
+    uint64_t period = drb_snapshot.published_periods() + 1;
 
-        return result;
+    // Only this group is sampled. DRB's published by another group in the last sampling are carried to this buffer.
+    if(last_drb_group != NULL && last_drb_group != group){
+        for(unsigned int i = 0; i < last_drb_group->ids.size(); i++){
+            drb_snapshot.carry_forward(last_drb_group->ids[i]);
+        }
     }
 
-    // Middle 21 bits are for PRACH_HIGH
-    case PRACH_RAND_HIGH: {
-        mask = SECOND_21_MASK;
-        uint64_t result = current_ssb_prach & mask;
+    if(trace_recorder != NULL){
+        int64_t args[1] = {group->index};
+        trace_recorder->record(TRACE_DRB_PERIOD, timestamp, args, 1);
+    }
 
-        result >>= 21;
+    // rte_metrics can only be read as a whole table, so it is read once per sampling instead of once per cell.
+    // Shards are still read per cell since that is a single load per shard.
+    std::vector<uint64_t> metric_value_table;
+    bool table_read = !multi_socket_mode && metric_handler.get_all_metrics(metric_value_table);
 
-        return result;
-    }
+    // Gather packed counts of all cells of the group into one contiguous buffer first, so that every DRB is a single slice for the kernel.
+    for(unsigned int i = 0; i < group->ids.size(); i++){
+        per_drb_measurements &drb = drb_measurement_map.find(group->ids[i])->second;
+        drb.cell_buffer_offset = cell_index;
 
-    // Remaining bits are for PRACH_RAND_LOW
-    case PRACH_RAND_LOW: {
-        mask = THIRD_21_MASK;
-        uint64_t result = current_ssb_prach & mask;
+        for(unsigned int j = 0; j < drb.cell_ids.size(); j++){
+            int cell_metric_id = drb.cell_ids[j];
 
-        result >>= 42;
+            if(table_read){
+                cell_count_buffer[cell_index] = (size_t) cell_metric_id < metric_value_table.size() ? metric_value_table[cell_metric_id] : 0;
+            }else if(!read_metric(cell_metric_id, cell_count_buffer[cell_index])){
+                cell_count_buffer[cell_index] = 0;
+            }
 
-        return result;
+            cell_index++;
+        }
     }
 
-    default:
-        return -1;
+    cell_index = 0;
+
+    if(report_encoder != NULL){
+        report_encoder->begin_record(REPORT_RECORD_DRB, period, 7);
     }
-}
 
+    rte_spinlock_lock(&rollup_lock);
 
+    for(unsigned int i = 0; i < group->ids.size(); i++){
+        int drb_id = group->ids[i];
+        per_drb_measurements &drb = drb_measurement_map.find(drb_id)->second;
+        unsigned int cell_count = drb.cell_ids.size();
+        uint64_t sample_values[2] = {0, 0};
 
-void LoggerLib::per_ssb_timer_callback(__rte_unused struct rte_timer *tim, void *arg){
-    //debug_print(LOG_OUTPUT_FILE,"Per SSB Timer Callback\n", NULL);
+        if(cell_count > 0){
+            packed_count_aggregate aggregate;
+            aggregate_kernel(&cell_count_buffer[cell_index], cell_count, &aggregate);
+            cell_index += cell_count;
 
-    std::map<int, per_ssb_measurements>::iterator iterator;
+            // Minimums are only meaningful after the first sample.
+            if(drb.sampled_cell_count == 0){
+                drb.min_active_ue_count = aggregate.min_low;
+                drb.min_inactive_ue_count = aggregate.min_high;
+            }
 
-    for(iterator = per_ssb_data.begin(); iterator != per_ssb_data.end(); iterator++){
-        iterator->second.values[0] = get_ssb_message_count(iterator->first, PRACH_DEDICATED);
-        iterator->second.values[1] = get_ssb_message_count(iterator->first, PRACH_RAND_HIGH);
-        iterator->second.values[2] = get_ssb_message_count(iterator->first, PRACH_RAND_LOW);
+            drb.max_active_ue_count = GENERIC_MAX(drb.max_active_ue_count, aggregate.max_low);
+            drb.min_active_ue_count = GENERIC_MIN(drb.min_active_ue_count, aggregate.min_low);
 
-        update_metric_value(iterator->first, 0, true);
-        debug_print(LOG_OUTPUT_FILE,"Per SSB Values ID: %d, PRACH_DEDICATED %d, PRACH_RAND_HIGH %d, PRACH_RAND_LOW %d\n", 
-                            iterator->first, iterator->second.values[0], iterator->second.values[1], iterator->second.values[2]);
-    }
-}
+            drb.max_inactive_ue_count = GENERIC_MAX(drb.max_inactive_ue_count, aggregate.max_high);
+            drb.min_inactive_ue_count = GENERIC_MIN(drb.min_inactive_ue_count, aggregate.min_high);
 
+            drb.total_active_ue_count += aggregate.sum_low;
+            drb.total_inactive_ue_count += aggregate.sum_high;
+            drb.sampled_cell_count += cell_count;
 
-void LoggerLib::per_drb_per_cell_timer_callback(__rte_unused struct rte_timer *tim, void *arg){
-    debug_print(LOG_OUTPUT_FILE, "Per DRB Per Cell Timer Callback\n", NULL);
-    std::map<int, per_drb_measurements>::iterator it;
-    
+            sample_values[0] = aggregate.sum_low;
+            sample_values[1] = aggregate.sum_high;
+        }
 
-    uint32_t active_count;
-    uint32_t inactive_count;
+        if(!drb.rollups.empty()){
+            update_rollups(drb.rollups, drb_id, sample_values, timestamp, completed_rollups);
+        }
 
-    for(it = drb_measurement_map.begin(); it != drb_measurement_map.end(); it++){
-        for(unsigned int i = 0; i < it->second.cell_ids.size(); i++){
-            get_active_inactive_ue_count(it->first, i, active_count, inactive_count);
-            
-            it->second.max_active_ue_count = GENERIC_MAX(it->second.max_active_ue_count, active_count);
-            it->second.min_active_ue_count = GENERIC_MIN(it->second.min_active_ue_count, active_count);
+        per_drb_statistics &statistics = snapshot[drb_id];
+
+        statistics.max_active_ue_count = drb.max_active_ue_count;
+        statistics.min_active_ue_count = drb.min_active_ue_count;
+        statistics.max_inactive_ue_count = drb.max_inactive_ue_count;
+        statistics.min_inactive_ue_count = drb.min_inactive_ue_count;
+        statistics.total_active_ue_count = drb.total_active_ue_count;
+        statistics.total_inactive_ue_count = drb.total_inactive_ue_count;
+        statistics.sampled_cell_count = drb.sampled_cell_count;
+
+        if(report_encoder != NULL){
+            int64_t fields[7] = {(int64_t) statistics.max_active_ue_count, (int64_t) statistics.min_active_ue_count, 
+                                    (int64_t) statistics.max_inactive_ue_count, (int64_t) statistics.min_inactive_ue_count,
+                                    (int64_t) statistics.total_active_ue_count, (int64_t) statistics.total_inactive_ue_count,
+                                    (int64_t) statistics.sampled_cell_count};
+            report_encoder->add_entry(drb_id, fields);
+        }
+    }
 
-            it->second.max_inactive_ue_count = GENERIC_MAX(it->second.max_inactive_ue_count, active_count);
-            it->second.min_inactive_ue_count = GENERIC_MIN(it->second.min_inactive_ue_count, active_count);
+    rte_spinlock_unlock(&rollup_lock);
 
-            it->second.total_active_ue_count += active_count;
-            it->second.total_inactive_ue_count += inactive_count;
-        }
+    if(report_encoder != NULL){
+        report_encoder->end_record();
     }
+
+    evaluate_cell_triggers(group);
+    drb_snapshot.end_write();
+    last_drb_group = group;
+
+    rte_spinlock_unlock(&registration_lock);
+
+    report_rollups(REPORT_RECORD_DRB_ROLLUP, period, 2, completed_rollups);
 }
 
 // Use the same trick to store two 32 bit numbers for active and inactive UE's. This way, we don't have to manage additional metrics and callbacks.
@@ -263,39 +1276,35 @@ bool LoggerLib::add_new_active_ue_to_cell(int drb_id, int cell_id, uint32_t coun
         return false;
     }
 
-    if(cell_id >= (int) it->second.cell_ids.size()){
+    if(cell_id < 0 || cell_id >= (int) it->second.cell_ids.size()){
         printf("Cell with ID %d is not found within DRB with ID %d\n", cell_id, drb_id);
         return false;
     }
 
     int cell_metric_id = it->second.cell_ids[cell_id];
 
-    uint64_t metric_value;
-    if(metric_handler.get_metric(cell_metric_id, metric_value)){
-        uint32_t active_count = metric_value & FIRST_32_MASK;
-        active_count += count;
-
-        metric_value &= (~FIRST_32_MASK);
-        metric_value += active_count;
+    // Active count is in the lower 32 bits. Moving UE's from inactive to active borrows from the upper 32 bits.
+    uint64_t delta = count;
 
+    if(!new_ue){
+        delta -= ((uint64_t) count) << 32;
+    }
 
+    if(!add_to_metric(cell_metric_id, (int64_t) delta)){
+        return false;
+    }
 
-        if(!new_ue){
-            uint64_t inactive_count = metric_value & LAST_32_MASK;
-            
-            inactive_count >>= 32;
-            inactive_count -= count;
-            inactive_count <<= 32;
+    if(trace_recorder != NULL){
+        int64_t args[4] = {drb_id, cell_id, count, new_ue};
+        trace_recorder->record(TRACE_ACTIVE_UE, clock->get_cycles(), args, 4);
+    }
 
-            metric_value &= (~LAST_32_MASK);
-            metric_value += inactive_count;
-        }
-        
-        return metric_handler.update_metric(cell_metric_id, metric_value, true);
-        // debug_print(LOG_OUTPUT_FILE,"New Cell Metric Value %llu\n", metric_value);
+    // Cells are keyed with DRB ID in the upper 16 bits and cell ID in the lower 16 bits.
+    if(heavy_hitter_top_k > 0){
+        update_heavy_hitters(HEAVY_HITTER_CELL_ACTIVE_UE, (((uint32_t) drb_id) << 16) | (uint32_t) cell_id, count);
     }
 
-    return false;
+    return true;
 }
 
 
@@ -308,37 +1317,30 @@ bool LoggerLib::add_new_inactive_ue_to_cell(int drb_id, int cell_id, uint32_t co
         return false;
     }
 
-    if(cell_id >= (int) it->second.cell_ids.size()){
+    if(cell_id < 0 || cell_id >= (int) it->second.cell_ids.size()){
         printf("Cell with ID %d is not found within DRB with ID %d\n", cell_id, drb_id);
         return false;
     }
 
     int cell_metric_id = it->second.cell_ids[cell_id];
 
-    uint64_t metric_value;
-    if(metric_handler.get_metric(cell_metric_id, metric_value)){
-        uint64_t inactive_count = metric_value & LAST_32_MASK;
-
-        inactive_count >>= 32;
-        inactive_count += count;
-        inactive_count <<= 32;
+    // Inactive count is in the upper 32 bits.
+    uint64_t delta = ((uint64_t) count) << 32;
 
-        metric_value &= (~LAST_32_MASK);
-        metric_value += inactive_count;
+    if(!new_ue){
+        delta -= count;
+    }
 
-        if(!new_ue){
-            uint32_t active_count = metric_value & FIRST_32_MASK;
-            active_count -= count;
+    if(!add_to_metric(cell_metric_id, (int64_t) delta)){
+        return false;
+    }
 
-            metric_value &= (~FIRST_32_MASK);
-            metric_value += active_count;
-        }
-        
-        return metric_handler.update_metric(cell_metric_id, metric_value, true);
-        // debug_print(LOG_OUTPUT_FILE,"New Cell Metric Value %llu\n", metric_value);
+    if(trace_recorder != NULL){
+        int64_t args[4] = {drb_id, cell_id, count, new_ue};
+        trace_recorder->record(TRACE_INACTIVE_UE, clock->get_cycles(), args, 4);
     }
 
-    return false;
+    return true;
 }
 
 
@@ -346,12 +1348,41 @@ bool LoggerLib::add_new_inactive_ue_to_cell(int drb_id, int cell_id, uint32_t co
 
 bool LoggerLib::add_new_drb(int &id, int ue_sample_frequency){
     struct per_drb_measurements drb;
-    ue_sampling_frequency = ue_sample_frequency;
+
+    if(drb_measurement_map.size() == MAX_DRB_COUNT){
+        printf("Maximum DRB count %d is reached\n", MAX_DRB_COUNT);
+        return false;
+    }
+
+    if(ue_sample_frequency <= 0){
+        printf("UE sampling frequency %d must be positive\n", ue_sample_frequency);
+        return false;
+    }
+
+    rte_spinlock_lock(&registration_lock);
+
+    // DRB's with the same frequency share a group, so a hot DRB sampled faster does not speed up the others.
+    sample_group *group = get_sample_group(SAMPLE_GROUP_DRB, clock->get_hz() / ue_sample_frequency);
+
+    if(group == NULL){
+        rte_spinlock_unlock(&registration_lock);
+        return false;
+    }
 
     // We can use size as ID since we don't support any deletion since rte_metrics does not support it.
     id = drb_measurement_map.size();
 
     drb_measurement_map.insert(std::make_pair(id, empty_measurements));
+    drb_measurement_map[id].ue_sampling_frequency = ue_sample_frequency;
+    drb_measurement_map[id].group = group;
+    group->ids.push_back(id);
+
+    rte_spinlock_unlock(&registration_lock);
+
+    if(trace_recorder != NULL){
+        int64_t args[2] = {ue_sample_frequency, id};
+        trace_recorder->record(TRACE_ADD_DRB, clock->get_cycles(), args, 2);
+    }
     // debug_print(LOG_OUTPUT_FILE,"A new DRB is added with ID %d\n", id);
     return true;
 }
@@ -374,22 +1405,23 @@ bool LoggerLib::add_new_cell_to_drb(int drb_id, int &cell_id){
     str += std::to_string(drb_id);
     str += std::to_string(cell_id);
 
-    if(metric_handler.register_metric(str.c_str(), cell_metric_id) == true){
+    if(register_metric(str.c_str(), cell_metric_id) == true){
         debug_print(LOG_OUTPUT_FILE,"A new per DRB per Cell metric has been created with ID: %d\n", cell_metric_id);
+
+        rte_spinlock_lock(&registration_lock);
         it->second.cell_ids.push_back(cell_metric_id);
+        cell_count_buffer.push_back(0);
+        rte_spinlock_unlock(&registration_lock);
+
+        if(trace_recorder != NULL){
+            int64_t args[2] = {drb_id, cell_id};
+            trace_recorder->record(TRACE_ADD_CELL, clock->get_cycles(), args, 2);
+        }
     }else{
         printf("Per DRB Per Cell Metric Registration has failed with DRB ID %d and Cell ID %d.\n", drb_id, cell_id);
         return false;
     }
-    
 
-    if(cell_id == 0){
-        // If we have pushed a cell_id for the first time, then we need to activate the sampling to UE contexts.
-        rte_timer_reset(&per_drb_per_cell_measurement_timer, rte_get_timer_hz() / ue_sampling_frequency, PERIODICAL, 
-                    current_core_id, per_drb_per_cell_callback, this);
-        ue_last_sampled_time = rte_rdtsc();
-    }
-   
     return true;
 }
 
@@ -405,7 +1437,7 @@ bool LoggerLib::get_active_inactive_ue_count(int drb_id, int cell_id, uint32_t &
         return false;
     }
 
-    if(cell_id >= (int) it->second.cell_ids.size()){
+    if(cell_id < 0 || cell_id >= (int) it->second.cell_ids.size()){
         printf("Cell with ID %d is not found within DRB with ID %d\n", cell_id, drb_id);
         return false;
     }
@@ -413,7 +1445,7 @@ bool LoggerLib::get_active_inactive_ue_count(int drb_id, int cell_id, uint32_t &
     int cell_metric_id = it->second.cell_ids[cell_id];
 
     uint64_t metric_value;
-    if(metric_handler.get_metric(cell_metric_id, metric_value)){
+    if(read_metric(cell_metric_id, metric_value)){
         active_count = metric_value & FIRST_32_MASK;
         uint64_t place_holder = metric_value & LAST_32_MASK;
 
@@ -424,4 +1456,425 @@ bool LoggerLib::get_active_inactive_ue_count(int drb_id, int cell_id, uint32_t &
 
 
     return false;
-}
\ No newline at end of file
+}
+
+
+void LoggerLib::initialize_triggers(int socket_id){
+    rte_spinlock_init(&trigger_lock);
+    next_trigger_rule_id = 0;
+    dropped_trigger_events = 0;
+
+    // Ring names are shared by every logger in the EAL and by secondary processes, so each logger gets its own.
+    static uint32_t trigger_ring_count = 0;
+    char ring_name[RTE_RING_NAMESIZE];
+
+    snprintf(ring_name, sizeof(ring_name), "logger_trig_%d_%u", (int) getpid(), 
+                __atomic_fetch_add(&trigger_ring_count, 1, __ATOMIC_RELAXED));
+
+    trigger_ring = rte_ring_create_elem(ring_name, sizeof(trigger_event), TRIGGER_RING_SIZE, socket_id, 0);
+
+    if(trigger_ring == NULL){
+        printf("Cannot create trigger notification ring %s on socket %d, trigger rules can not be added\n", ring_name, socket_id);
+    }
+}
+
+bool LoggerLib::add_trigger_rule(uint8_t source, int entity_id, int sub_id, uint8_t kind, double threshold, double ewma_alpha, int &rule_id){
+    if(trigger_ring == NULL){
+        printf("Trigger notification ring is not available\n");
+        return false;
+    }
+
+    if(kind < TRIGGER_THRESHOLD_ABOVE || kind > TRIGGER_EWMA_DEVIATION){
+        printf("Trigger kind %u is not valid\n", kind);
+        return false;
+    }
+
+    if(kind == TRIGGER_EWMA_DEVIATION && (ewma_alpha <= 0 || ewma_alpha > 1)){
+        printf("EWMA weight %f must be in (0, 1]\n", ewma_alpha);
+        return false;
+    }
+
+    if(source == TRIGGER_SOURCE_SSB_PRACH){
+        if(per_ssb_data.find(entity_id) == per_ssb_data.end() || ssb_value_index(sub_id) < 0){
+            printf("SSB with ID %d and PRACH type %d is not found\n", entity_id, sub_id);
+            return false;
+        }
+    }else if(source == TRIGGER_SOURCE_CELL_ACTIVE_UE || source == TRIGGER_SOURCE_CELL_INACTIVE_UE){
+        std::map<int, per_drb_measurements>::iterator it = drb_measurement_map.find(entity_id);
+
+        if(it == drb_measurement_map.end() || sub_id < 0 || sub_id >= (int) it->second.cell_ids.size()){
+            printf("Cell with ID %d is not found within DRB with ID %d\n", sub_id, entity_id);
+            return false;
+        }
+    }else{
+        printf("Trigger source %u is not valid\n", source);
+        return false;
+    }
+
+    trigger_rule rule;
+    memset(&rule, 0, sizeof(rule));
+
+    rule.kind = kind;
+    rule.source = source;
+    rule.entity_id = entity_id;
+    rule.sub_id = sub_id;
+    rule.threshold = threshold;
+    rule.ewma_alpha = ewma_alpha;
+
+    rte_spinlock_lock(&trigger_lock);
+
+    rule.rule_id = next_trigger_rule_id++;
+    rule_id = rule.rule_id;
+
+    if(source == TRIGGER_SOURCE_SSB_PRACH){
+        ssb_trigger_rules.push_back(rule);
+    }else{
+        cell_trigger_rules.push_back(rule);
+    }
+
+    rte_spinlock_unlock(&trigger_lock);
+
+    debug_print(LOG_OUTPUT_FILE, "A new trigger rule has been created with ID: %d\n", rule_id);
+    return true;
+}
+
+bool LoggerLib::remove_trigger_rule(int rule_id){
+    std::vector<trigger_rule> *rule_lists[2] = {&ssb_trigger_rules, &cell_trigger_rules};
+    bool found = false;
+
+    rte_spinlock_lock(&trigger_lock);
+
+    for(unsigned int i = 0; i < 2 && !found; i++){
+        for(unsigned int j = 0; j < rule_lists[i]->size(); j++){
+            if((*rule_lists[i])[j].rule_id == rule_id){
+                rule_lists[i]->erase(rule_lists[i]->begin() + j);
+                found = true;
+                break;
+            }
+        }
+    }
+
+    rte_spinlock_unlock(&trigger_lock);
+
+    return found;
+}
+
+unsigned int LoggerLib::poll_trigger_events(trigger_event *events, unsigned int max_events){
+    if(trigger_ring == NULL){
+        return 0;
+    }
+
+    return rte_ring_dequeue_burst_elem(trigger_ring, events, sizeof(trigger_event), max_events, NULL);
+}
+
+uint64_t LoggerLib::get_dropped_trigger_event_count(){
+    return __atomic_load_n(&dropped_trigger_events, __ATOMIC_RELAXED);
+}
+
+void LoggerLib::push_trigger_event(trigger_rule &rule, int64_t value, double reference, uint64_t timestamp){
+    trigger_event event;
+
+    event.rule_id = rule.rule_id;
+    event.kind = rule.kind;
+    event.source = rule.source;
+    event.entity_id = rule.entity_id;
+    event.sub_id = rule.sub_id;
+    event.value = value;
+    event.reference = reference;
+    event.timestamp = timestamp;
+
+    if(rte_ring_enqueue_burst_elem(trigger_ring, &event, sizeof(trigger_event), 1, NULL) == 0){
+        __atomic_fetch_add(&dropped_trigger_events, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void LoggerLib::evaluate_ssb_triggers(per_ssb_measurements *snapshot, sample_group *group){
+    uint64_t timestamp = clock->get_cycles();
+    double reference;
+
+    rte_spinlock_lock(&trigger_lock);
+
+    // Only the SSB's with rules are visited, cost does not depend on the number of SSB's.
+    for(unsigned int i = 0; i < ssb_trigger_rules.size(); i++){
+        trigger_rule &rule = ssb_trigger_rules[i];
+
+        // SSB's of other groups are not sampled in this period.
+        if(per_ssb_data.find(rule.entity_id)->second.group != group){
+            continue;
+        }
+
+        int64_t value = snapshot[rule.entity_id].values[ssb_value_index(rule.sub_id)];
+
+        if(evaluate_trigger_rule(rule, value, reference)){
+            push_trigger_event(rule, value, reference, timestamp);
+        }
+    }
+
+    rte_spinlock_unlock(&trigger_lock);
+}
+
+void LoggerLib::evaluate_cell_triggers(sample_group *group){
+    uint64_t timestamp = clock->get_cycles();
+    double reference;
+
+    rte_spinlock_lock(&trigger_lock);
+
+    for(unsigned int i = 0; i < cell_trigger_rules.size(); i++){
+        trigger_rule &rule = cell_trigger_rules[i];
+        std::map<int, per_drb_measurements>::iterator it = drb_measurement_map.find(rule.entity_id);
+
+        // Cells of other groups are not gathered in this sampling.
+        if(it->second.group != group){
+            continue;
+        }
+
+        uint64_t packed_count = cell_count_buffer[it->second.cell_buffer_offset + rule.sub_id];
+        int64_t value = rule.source == TRIGGER_SOURCE_CELL_ACTIVE_UE ? (packed_count & FIRST_32_MASK) : (packed_count >> 32);
+
+        if(evaluate_trigger_rule(rule, value, reference)){
+            push_trigger_event(rule, value, reference, timestamp);
+        }
+    }
+
+    rte_spinlock_unlock(&trigger_lock);
+}
+
+
+
+bool LoggerLib::enable_heavy_hitters(unsigned int top_k){
+    if(top_k == 0 || top_k > HEAVY_HITTER_MAX_K){
+        printf("Heavy hitter count %u must be between 1 and %d\n", top_k, HEAVY_HITTER_MAX_K);
+        return false;
+    }
+
+    if(heavy_hitter_top_k > 0){
+        printf("Heavy hitter tracking is already enabled\n");
+        return false;
+    }
+
+    // Reports of a failed earlier call are reused.
+    if(!heavy_hitter_snapshot.is_initialized() &&
+            !heavy_hitter_snapshot.initialize(HEAVY_HITTER_SOURCE_COUNT, rte_lcore_to_socket_id(current_core_id))){
+        printf("Cannot allocate heavy hitter reports\n");
+        return false;
+    }
+
+    // Sketches are rotated at the end of the periods of the first SSB group. Create a one second group if there is none.
+    rte_spinlock_lock(&registration_lock);
+    bool has_group = !ssb_groups.empty() || get_sample_group(SAMPLE_GROUP_SSB, clock->get_hz()) != NULL;
+    rte_spinlock_unlock(&registration_lock);
+
+    if(!has_group){
+        return false;
+    }
+
+    heavy_hitter_sketches.assign(RTE_MAX_LCORE * HEAVY_HITTER_SOURCE_COUNT * HEAVY_HITTER_SKETCH_SLOTS, NULL);
+    heavy_hitter_counters.assign(HEAVY_HITTER_SKETCH_COUNTERS, 0);
+
+    // Sketches of an lcore are allocated on its own socket.
+    unsigned int lcore_id;
+    RTE_LCORE_FOREACH(lcore_id){
+        for(unsigned int i = 0; i < HEAVY_HITTER_SOURCE_COUNT * HEAVY_HITTER_SKETCH_SLOTS; i++){
+            HeavyHitterSketch *sketch = new HeavyHitterSketch();
+
+            if(!sketch->initialize(top_k, rte_lcore_to_socket_id(lcore_id))){
+                delete sketch;
+                free_heavy_hitter_sketches();
+                printf("Cannot allocate heavy hitter sketch for lcore %u\n", lcore_id);
+                return false;
+            }
+
+            heavy_hitter_sketches[lcore_id * HEAVY_HITTER_SOURCE_COUNT * HEAVY_HITTER_SKETCH_SLOTS + i] = sketch;
+        }
+    }
+
+    __atomic_store_n(&heavy_hitter_top_k, top_k, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+unsigned int LoggerLib::get_heavy_hitters(uint8_t source, heavy_hitter *entries, unsigned int max_entries, uint64_t *total_weight){
+    heavy_hitter_report report;
+
+    if(source >= HEAVY_HITTER_SOURCE_COUNT || !heavy_hitter_snapshot.read(source, report)){
+        return 0;
+    }
+
+    unsigned int count = GENERIC_MIN(max_entries, report.count);
+    memcpy(entries, report.entries, sizeof(heavy_hitter) * count);
+
+    if(total_weight != NULL){
+        *total_weight = report.total_weight;
+    }
+
+    return count;
+}
+
+void LoggerLib::update_heavy_hitters(uint8_t source, uint32_t key, uint64_t weight){
+    unsigned int lcore_id = rte_lcore_id();
+
+    if(lcore_id >= RTE_MAX_LCORE){
+        return;
+    }
+
+    unsigned int slot = __atomic_load_n(&heavy_hitter_period, __ATOMIC_RELAXED) % HEAVY_HITTER_SKETCH_SLOTS;
+    HeavyHitterSketch *sketch = heavy_hitter_sketches[(lcore_id * HEAVY_HITTER_SOURCE_COUNT + source) * HEAVY_HITTER_SKETCH_SLOTS + slot];
+
+    if(sketch != NULL){
+        sketch->update(key, weight);
+    }
+}
+
+static bool compare_heavy_hitters(const heavy_hitter &first, const heavy_hitter &second){
+    return first.estimate > second.estimate;
+}
+
+// An update that loaded the period just before it changed may still be writing to the sketch of the finished period.
+// That sketch is left alone for a whole period. Sketches of the period before it are merged and reset instead, and
+// they are not used again until the period after the next one.
+void LoggerLib::rotate_heavy_hitters(){
+    uint64_t finished_period = heavy_hitter_period;
+
+    __atomic_store_n(&heavy_hitter_period, finished_period + 1, __ATOMIC_RELEASE);
+
+    if(finished_period == 0){
+        return;
+    }
+
+    unsigned int merged_slot = (finished_period - 1) % HEAVY_HITTER_SKETCH_SLOTS;
+    heavy_hitter_report *reports = heavy_hitter_snapshot.begin_write();
+
+    for(unsigned int source = 0; source < HEAVY_HITTER_SOURCE_COUNT; source++){
+        std::vector<uint32_t> candidates;
+        std::vector<heavy_hitter> estimates;
+        uint64_t total_weight = 0;
+
+        std::fill(heavy_hitter_counters.begin(), heavy_hitter_counters.end(), 0);
+
+        for(unsigned int lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++){
+            HeavyHitterSketch *sketch = heavy_hitter_sketches[(lcore_id * HEAVY_HITTER_SOURCE_COUNT + source) * HEAVY_HITTER_SKETCH_SLOTS + merged_slot];
+
+            if(sketch == NULL){
+                continue;
+            }
+
+            sketch->add_counters_to(heavy_hitter_counters.data());
+            candidates.insert(candidates.end(), sketch->get_candidate_keys(), sketch->get_candidate_keys() + sketch->get_candidate_count());
+            total_weight += sketch->get_total_weight();
+
+            sketch->reset();
+        }
+
+        // Same key can be a candidate on many lcores. Estimate every key once from the merged counters.
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        for(unsigned int i = 0; i < candidates.size(); i++){
+            heavy_hitter entry;
+
+            if(source == HEAVY_HITTER_SSB_PRACH){
+                entry.entity_id = candidates[i];
+                entry.sub_id = 0;
+            }else{
+                entry.entity_id = candidates[i] >> 16;
+                entry.sub_id = candidates[i] & 0xFFFF;
+            }
+
+            entry.estimate = HeavyHitterSketch::estimate(heavy_hitter_counters.data(), candidates[i]);
+            estimates.push_back(entry);
+        }
+
+        std::sort(estimates.begin(), estimates.end(), compare_heavy_hitters);
+
+        reports[source].total_weight = total_weight;
+        reports[source].count = GENERIC_MIN(estimates.size(), heavy_hitter_top_k);
+
+        for(unsigned int i = 0; i < reports[source].count; i++){
+            reports[source].entries[i] = estimates[i];
+        }
+    }
+
+    heavy_hitter_snapshot.end_write();
+}
+
+bool LoggerLib::create_event_ring(const char *ring_name, unsigned int ring_size){
+    if(rte_eal_process_type() != RTE_PROC_PRIMARY){
+        printf("Event ring can only be created by the primary process\n");
+        return false;
+    }
+
+    if(event_ring != NULL){
+        printf("Event ring is already created\n");
+        return false;
+    }
+
+    // Producers reserve slots and fill them in place, zero copy enqueue needs head/tail sync producers.
+    event_ring = rte_ring_create_elem(ring_name, sizeof(logger_event), ring_size, rte_lcore_to_socket_id(current_core_id),
+                                        RING_F_MP_HTS_ENQ | RING_F_SC_DEQ);
+
+    if(event_ring == NULL){
+        printf("Cannot create event ring %s with size %u\n", ring_name, ring_size);
+        return false;
+    }
+
+    debug_print(LOG_OUTPUT_FILE, "Event ring %s has been created with size %u\n", ring_name, ring_size);
+    return true;
+}
+
+unsigned int LoggerLib::drain_event_ring(){
+    logger_event events[LOGGER_EVENT_BURST];
+    unsigned int folded = 0;
+    unsigned int count;
+
+    if(event_ring == NULL){
+        return 0;
+    }
+
+    // At most one ring worth of events per call, producers can not keep the logger lcore here forever.
+    do{
+        count = rte_ring_dequeue_burst_elem(event_ring, events, sizeof(logger_event), LOGGER_EVENT_BURST, NULL);
+
+        // IDs may be registered on another lcore while the events are folded.
+        rte_spinlock_lock(&registration_lock);
+
+        for(unsigned int i = 0; i < count; i++){
+            logger_event &event = events[i];
+            bool result;
+
+            switch (event.type)
+            {
+            // Metric ID of an SSB is its SSB ID, so an unknown ID could land on any other metric.
+            case LOGGER_EVENT_PRACH:
+                result = per_ssb_data.find(event.id) != per_ssb_data.end() && 
+                            on_ssb_prach_receive(event.id, event.prach_type, event.count);
+                break;
+
+            case LOGGER_EVENT_ACTIVE_UE:
+                result = add_new_active_ue_to_cell(event.id, event.cell_id, event.count, event.new_ue);
+                break;
+
+            case LOGGER_EVENT_INACTIVE_UE:
+                result = add_new_inactive_ue_to_cell(event.id, event.cell_id, event.count, event.new_ue);
+                break;
+
+            default:
+                result = false;
+                break;
+            }
+
+            if(!result){
+                __atomic_fetch_add(&invalid_events, 1, __ATOMIC_RELAXED);
+            }
+        }
+
+        rte_spinlock_unlock(&registration_lock);
+
+        folded += count;
+    } while(count == LOGGER_EVENT_BURST && folded < rte_ring_get_size(event_ring));
+
+    return folded;
+}
+
+uint64_t LoggerLib::get_invalid_event_count(){
+    return __atomic_load_n(&invalid_events, __ATOMIC_RELAXED);
+}
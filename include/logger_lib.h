@@ -4,11 +4,29 @@
 #include "rte_timer.h"
 #include "rte_metrics.h"
 #include "rte_malloc.h"
+#include "rte_lcore.h"
+#include "rte_ring.h"
+#include "rte_eal.h"
+#include "rte_service.h"
+#include "rte_service_component.h"
+#include "rte_spinlock.h"
 #include "logger_config.h"
+#include "socket_metric_interface.h"
+#include "snapshot_buffer.h"
+#include "aggregate_kernels.h"
+#include "report_encoder.h"
+#include "trigger_rules.h"
+#include "heavy_hitter_sketch.h"
+#include "logger_clock.h"
+#include "trace_recorder.h"
+#include "logger_event.h"
+#include "measurement_rollup.h"
 #include "vector"
 #include "map"
 
-#define DEBUG 1
+#ifndef DEBUG
+    #define DEBUG 1
+#endif
 
 struct per_ssb_measurements
 {
@@ -17,6 +35,23 @@ struct per_ssb_measurements
 
 per_ssb_measurements empty_ssb_measurements = {0, 0, 0};
 
+struct sample_group;
+
+// Sampling state of an SSB.
+struct per_ssb_state{
+
+    // Results of the last sample
+    per_ssb_measurements measurements;
+
+    uint32_t sample_period_ms;
+
+    // Group that samples this SSB
+    sample_group *group;
+
+    // Accumulators of the reporting periods
+    std::vector<rollup_resolution> rollups;
+};
+
 // Structure to hold necessary data about per DRB measurements.
 // Assumption about this structure is that one DRB holds multiple cells.
 struct per_drb_measurements{
@@ -35,12 +70,205 @@ struct per_drb_measurements{
     // Accumulate Total Inactive UE Count to take an average
     uint64_t total_inactive_ue_count;
 
+    // Number of cell samples accumulated in the totals
+    uint64_t sampled_cell_count;
+
+    // Where the cells of this DRB start in the gathered cell counts of the last sampling
+    unsigned int cell_buffer_offset;
+
+    int ue_sampling_frequency;
+
+    // Group that samples this DRB
+    sample_group *group;
+
+    // Accumulators of the reporting periods
+    std::vector<rollup_resolution> rollups;
+
     // Cell IDs
     std::vector<int> cell_ids;
 };
 
 struct per_drb_measurements empty_measurements;
 
+// Sampled UE statistics of a DRB. Copy of per_drb_measurements without the cell list so that it can be published
+// to readers on other lcores.
+struct per_drb_statistics{
+
+    uint64_t max_active_ue_count;
+
+    uint64_t min_active_ue_count;
+
+    uint64_t max_inactive_ue_count;
+
+    uint64_t min_inactive_ue_count;
+
+    uint64_t total_active_ue_count;
+
+    uint64_t total_inactive_ue_count;
+
+    uint64_t sampled_cell_count;
+};
+
+// Heavy hitter sources
+// SSB's with the most PRACH messages. Entity ID is the SSB ID.
+#define HEAVY_HITTER_SSB_PRACH 0U
+// Cells with the most UE activations. Entity ID is the DRB ID and sub ID is the cell ID.
+#define HEAVY_HITTER_CELL_ACTIVE_UE 1U
+
+#define HEAVY_HITTER_SOURCE_COUNT 2
+
+// Sketches per lcore and source. Lcores update the sketch of the current period while the sketch of the period
+// before the last one is merged and reset, so updates that were in flight when the period changed have finished.
+#define HEAVY_HITTER_SKETCH_SLOTS 3
+
+struct heavy_hitter{
+
+    int entity_id;
+
+    int sub_id;
+
+    // Estimated weight in the period. Never less than the real weight.
+    uint64_t estimate;
+};
+
+// Heavy hitters of a source in the last period, sorted by estimate.
+struct heavy_hitter_report{
+
+    // Total weight of all keys in the period
+    uint64_t total_weight;
+
+    uint32_t count;
+
+    heavy_hitter entries[HEAVY_HITTER_MAX_K];
+};
+
+class LoggerLib;
+
+// A periodic callback of the logger. Tasks are run by LoggerTick on their own lcore once the logger clock passes
+// their deadline, or in deadline order by run_simulation_until when the clock is simulated.
+struct logger_period_task{
+
+    uint64_t period_cycles;
+
+    uint64_t next_deadline;
+
+    unsigned int lcore_id;
+
+    rte_timer_cb_t callback;
+
+    void *arg;
+};
+
+// Scheduling state of the period tasks of a logger lcore. Only touched by the lcore that runs its tasks,
+// jitter values are also read by other lcores.
+struct lcore_task_state{
+
+    // Earliest deadline of the tasks of the lcore. UINT64_MAX if it has no tasks.
+    uint64_t next_deadline;
+
+    // Task list generation the deadline was computed for. Deadline is recomputed when tasks change.
+    uint32_t generation;
+
+    // Last time rte_timer_manage was run by LoggerTick
+    uint64_t prev_tsc;
+
+    // How late the last and the latest period callbacks were run, in cycles
+    uint64_t last_jitter_cycles;
+
+    uint64_t max_jitter_cycles;
+
+    // Metrics the jitter is exported to in nanoseconds. -1 until the services are registered.
+    int jitter_last_metric_id;
+
+    int jitter_max_metric_id;
+
+    // Values written to the jitter metrics so far. Metrics are updated with differences.
+    uint64_t reported_last_jitter_ns;
+
+    uint64_t reported_max_jitter_ns;
+};
+
+// A DPDK service that runs the period tasks of a logger lcore on any service lcore.
+struct logger_service{
+
+    LoggerLib *logger;
+
+    // Logger lcore whose tasks are run
+    unsigned int lcore_id;
+
+    uint32_t service_id;
+
+    // Adaptive backoff while the lcore has nothing to do. Calls to skip before checking again and the next backoff.
+    uint32_t idle_skip;
+
+    uint32_t backoff;
+};
+
+// Per socket state used in multi socket mode. Everything in here is only written by the logger lcore of the socket
+// except the lcore list which is filled once in the constructor. Period values are also read by the socket that publishes.
+struct per_socket_shard{
+
+    // Owner of the shard. Needed in timer callbacks.
+    LoggerLib *logger;
+
+    int socket_id;
+
+    // Lcore that runs the timers of this socket. Its LoggerTick must be called regularly.
+    unsigned int logger_lcore_id;
+
+    // Enabled lcores that belong to this socket. Their metric shards are drained by the logger lcore.
+    std::vector<unsigned int> lcore_ids;
+
+    // Drained SSB values indexed by SSB ID, one buffer per period parity. Allocated on the socket itself.
+    // A buffer is only rewritten after the period it holds has been published.
+    uint64_t *ssb_period_values[2];
+};
+
+// Kinds of sample groups
+#define SAMPLE_GROUP_SSB 0U
+#define SAMPLE_GROUP_DRB 1U
+
+// Part of an SSB sample group that drains a single socket in multi socket mode.
+struct sample_group_socket{
+
+    sample_group *group;
+
+    per_socket_shard *socket;
+
+    int task_id;
+
+    // Last period of the group drained by this socket. Written by the logger lcore of the socket.
+    uint64_t drained_period;
+};
+
+// Measurements of the same kind that are sampled with the same period. Each group has its own period task,
+// so sampling a group only costs as much as its own measurements.
+struct sample_group{
+
+    LoggerLib *logger;
+
+    uint8_t kind;
+
+    // Position of the group among the groups of the same kind. Groups are numbered in creation order.
+    unsigned int index;
+
+    uint64_t period_cycles;
+
+    int task_id;
+
+    // SSB or DRB ID's in increasing order
+    std::vector<int> ids;
+
+    // Per socket tasks of SSB groups in multi socket mode
+    std::vector<sample_group_socket> sockets;
+
+    // Last period claimed for publishing and last period published in multi socket mode. A period is published
+    // once every socket has drained it, by the socket that claims it.
+    uint64_t claimed_period;
+
+    uint64_t published_period;
+};
+
 /** This is a class to handle necessary logging in 5G context. Currently, it uses rte_metrics backed metric services.
  * This service is somewhat convienient to use but also inefficient. By using mempool structures of the DPDK directly,
  * memory performance of the class can be improved significantly. Also, the class does not support deleting a added metric since
@@ -51,16 +279,28 @@ class LoggerLib {
         /** This function handles all the initialization necessary for logging library. This function
          * should be called from a main lcore thread. Please call
          * before delegating tasks to lcores. 
+         * Registration functions must be called from a single lcore. Logger lcores and services keep sampling while
+         * measurements are registered, but update functions look IDs up without a lock, so registrations should be
+         * finished before worker lcores start updating measurements.
         **/
         LoggerLib(int core_socket_id);
 
+        /** Multi socket initialization. Metric values are kept in per lcore shards allocated on the socket of each lcore
+         * so that updates never cross the socket boundary. Every socket drains its own shards on its logger lcore
+         * and a period is merged into a single report once every socket has drained it.
+         * @param logger_lcore_ids One lcore per socket to run the timers on. LoggerTick must be called on all of them.
+         * Per DRB per cell sampling runs on the first lcore in the list.
+        **/
+        LoggerLib(const std::vector<unsigned int> &logger_lcore_ids);
+
         /** Add a new SSB PRACH for Logging. Return true if successfull. ID parameter is filled with
         * correct ID of the SSB. ID's are simply next index in the array. Library currently
         * does not support deleting SSB's. This interface is exactly the same as PRACH per cell measurements.
         * Without the need of additional interface, this functions can be used for per cell as well.
+        * @param sample_period_ms How often PRACH counts of the SSB are sampled and reset. SSB's with the same period are sampled together.
         * @returns True if successful and ID of the new SSB
         * **/
-        bool add_new_ssb(int &id);
+        bool add_new_ssb(int &id, uint32_t sample_period_ms = 1000);
 
         /** This function updates the received PRACH count for the given SSB with ID 
         * @param id ID of the SSB.
@@ -75,10 +315,33 @@ class LoggerLib {
         /** Tick function for the timers. When this is called, timer callbacks are executed and values
         *   of the metrics are updated. Sensitivity of the callbacks are handled by: 
         * @param TIMER_RESOLUTION_CYCLES_LOGGER_LIB: Cycle count to check new callbacks.
+        * Logger periods are measured with the logger clock. rte_timer callbacks of the application are also run.
         *  **/ 
         void LoggerTick();
 
-        /** Update the Metric Values.
+        /** Register the logger as DPDK services so that period tasks and the event ring are handled on service lcores
+         * instead of LoggerTick. One service is registered per logger lcore, named "logger_<lcore>". Each one should be
+         * mapped to a service lcore on the same socket as its logger lcore and started by the application.
+         * LoggerTick must not be called on logger lcores that have a service. Period jitter metrics
+         * "logger_jitter_last_ns_<lcore>" and "logger_jitter_max_ns_<lcore>" are registered here.
+         * @param service_ids IDs of the services in logger lcore order
+         * **/
+        bool register_services(std::vector<uint32_t> &service_ids);
+
+        /** How late the period callbacks of a logger lcore were run compared to their deadlines.
+         * Safe to call from any lcore.
+         * **/
+        bool get_period_jitter(unsigned int lcore_id, uint64_t &last_jitter_ns, uint64_t &max_jitter_ns);
+
+        /** Run every period callback that is due up to @param target_cycles in deadline order, moving the clock to each
+         * deadline before its callback, and leave the clock at the target. A day of periods can be run in seconds this way.
+         * Only possible when the logger clock is a VirtualClock. LoggerTick should not be called while simulating.
+         * @returns Number of callbacks run, -1 if the logger clock is not virtual
+         * **/
+        int64_t run_simulation_until(uint64_t target_cycles);
+
+        /** Update the Metric Values. In multi socket mode values are added to the shard of the calling lcore. An absolute
+         * update sets that shard and clears the others, so adds made on other lcores at the same time may be lost.
          * @param metric_id ID of the metric to update
          * @param value Updated Value
          * @param absolute If this is true, metric value is set to @param value. If false, @param value is added to the current value.
@@ -90,17 +353,29 @@ class LoggerLib {
         int get_ssb_message_count(int ssb_id, uint8_t prach_type);
 
         // Get of the Three SSB Values for given ID. These values are the measured frequency in the last iteration and before values are reset.
+        // Safe to call from any lcore. Returns -1 if no period has completed yet.
         int get_ssb_message_frequency(int ssb_id, uint8_t prach_type);
 
+        /** Get all three SSB values of the last completed period at once. Values always belong to the same period.
+         * Safe to call from any lcore, never blocks the sampling lcore.
+         * @returns False if the SSB is not found or no period has completed yet
+         * **/
+        bool get_ssb_measurements(int ssb_id, per_ssb_measurements &measurements);
+
+        /** Get the UE statistics of the DRB as of the last sampling. Safe to call from any lcore, never blocks the sampling lcore.
+         * @returns False if the DRB is not found or it is not sampled yet
+         * **/
+        bool get_drb_ue_statistics(int drb_id, per_drb_statistics &statistics);
+
         /** Add a new DRB measurement metric. Return its ID in parameter
          * @param drb_id ID of the parent DRB
-         * @param ue_sampling_frequency Frequency of the polling about UE's in the DRB. Must be at least 10Hz.
+         * @param ue_sampling_frequency Frequency of the polling about UE's in the DRB. Each DRB keeps its own frequency,
+         * DRB's with the same frequency are sampled together.
          * **/
         bool add_new_drb(int &id, int ue_sampling_frequency);
 
-        /** Add a new cell to DRB.
+        /** Add a new cell to DRB. Cells are sampled with the frequency of their DRB.
          * @param drb_id ID of the parent DRB
-         * @param ue_sampling_frequency Frequency of the polling about UE's in the DRB. Must be at least 10Hz.
          * @param cell_id ID of the newly created cell
          * **/
         bool add_new_cell_to_drb(int drb_id, int &cell_id);
@@ -123,47 +398,303 @@ class LoggerLib {
         bool add_new_inactive_ue_to_cell(int drb_id, int cell_id, uint32_t count, bool new_ue = true);
 
 
-        // Per SSB Calculation Callback
+        /** Write the results of every SSB period and DRB sampling to a binary report stream. Pass NULL to stop.
+         * Encoder is not owned by the logger and must outlive it or be removed first.
+         * **/
+        void set_report_encoder(ReportEncoder *encoder);
+
+        /** Summarize the samples of an SSB or DRB over a reporting period. Min, max and sum of every sample value are
+         * accumulated at sample time in constant time per sample. Completed windows can be read with get_rollup and are
+         * written to the report stream.
+         * @param source ROLLUP_SOURCE_SSB or ROLLUP_SOURCE_DRB
+         * @param period_ms Reporting period. Must be a multiple of the sample period of the measurement.
+         * **/
+        bool add_reporting_period(uint8_t source, int id, uint32_t period_ms);
+
+        /** Get the last completed window of a reporting period. Safe to call from any lcore.
+         * @returns False if the period is not registered or no window has completed yet
+         * **/
+        bool get_rollup(uint8_t source, int id, uint32_t period_ms, measurement_rollup &rollup);
+
+        /** Register a rule that is evaluated every time the measurement is sampled. Only the rules that trigger
+         * generate notifications, so readers do not need to poll every SSB or cell. Rules are checked against the
+         * registered SSB's and DRB's, so like the registration functions this must be called from the lcore that
+         * registers them. Sampling keeps running on the logger lcores meanwhile.
+         * @param source One of TRIGGER_SOURCE_SSB_PRACH, TRIGGER_SOURCE_CELL_ACTIVE_UE, TRIGGER_SOURCE_CELL_INACTIVE_UE
+         * @param entity_id ID of the SSB or the DRB
+         * @param sub_id PRACH type for SSB's, ID of the cell in the DRB for cells
+         * @param kind One of TRIGGER_THRESHOLD_ABOVE, TRIGGER_THRESHOLD_BELOW, TRIGGER_RATE_OF_CHANGE, TRIGGER_EWMA_DEVIATION
+         * @param threshold Threshold value, change per sample or number of standard deviations depending on the kind
+         * @param ewma_alpha Weight of new samples for TRIGGER_EWMA_DEVIATION. Ignored for other kinds.
+         * @param rule_id ID of the new rule
+         * @returns False if the rule is not valid or the notification ring could not be created
+         * **/
+        bool add_trigger_rule(uint8_t source, int entity_id, int sub_id, uint8_t kind, double threshold, double ewma_alpha, int &rule_id);
+
+        // Remove a registered rule. Returns false if it is not found.
+        bool remove_trigger_rule(int rule_id);
+
+        /** Dequeue notifications of triggered rules. Safe to call from any lcore.
+         * @returns Number of events written to @param events
+         * **/
+        unsigned int poll_trigger_events(trigger_event *events, unsigned int max_events);
+
+        // Number of notifications dropped because the ring was full.
+        uint64_t get_dropped_trigger_event_count();
+
+        /** Start tracking the busiest SSB's by PRACH messages and the busiest cells by UE activations with count-min sketches.
+         * Every lcore updates its own sketch and sketches are merged at the end of every SSB period, so memory does not depend
+         * on the number of SSB's or cells.
+         * @param top_k Number of heavy hitters to report per source, at most HEAVY_HITTER_MAX_K
+         * **/
+        bool enable_heavy_hitters(unsigned int top_k);
+
+        /** Get the heavy hitters of the period before the last one. Sketches are merged one period after their period
+         * ends, so that no lcore is still updating them. Safe to call from any lcore.
+         * @param source HEAVY_HITTER_SSB_PRACH or HEAVY_HITTER_CELL_ACTIVE_UE
+         * @returns Number of entries written to @param entries
+         * **/
+        unsigned int get_heavy_hitters(uint8_t source, heavy_hitter *entries, unsigned int max_entries, uint64_t *total_weight = NULL);
+
+        /** Read all timestamps and periods from the given clock instead of the TSC. Should be set before any measurement
+         * is added. Clock is not owned by the logger. Pass NULL to go back to the TSC.
+         * **/
+        void set_clock(LoggerClock *new_clock);
+
+        /** Create a named multi producer ring in shared memory that secondary processes push events into with LoggerProducer.
+         * Events are folded into the same measurements by LoggerTick on the first logger lcore. In multi socket mode they
+         * go to the shard of that lcore, which has no other writer. Otherwise they are added atomically next to the worker lcores.
+         * Only the primary process can create the ring.
+         * @param ring_size Number of events the ring can hold, must be a power of two
+         * **/
+        bool create_event_ring(const char *ring_name = LOGGER_EVENT_RING_NAME, unsigned int ring_size = LOGGER_EVENT_RING_SIZE);
+
+        /** Fold the events waiting in the ring into the measurements. Called by LoggerTick, can be called directly
+         * when the clock is simulated. Must be called from a single lcore.
+         * @returns Number of events folded
+         * **/
+        unsigned int drain_event_ring();
+
+        // Number of events from producers with an unknown type or an unknown SSB, DRB or cell ID.
+        uint64_t get_invalid_event_count();
+
+        /** Record every API call and period callback to a binary trace. Pass NULL to stop recording.
+         * Recorder is not owned by the logger and must outlive it or be removed first.
+         * **/
+        void set_trace_recorder(TraceRecorder *recorder);
+
+        /** Sample a group right now. Used by trace replay in single socket mode.
+         * @param kind SAMPLE_GROUP_SSB or SAMPLE_GROUP_DRB
+         * @param index Groups of a kind are numbered in creation order
+         * **/
+        bool run_sample_group(uint8_t kind, unsigned int index);
+
+        // Per SSB Calculation Callback. Arg is the sample_group, first SSB group is sampled if it is NULL.
         void per_ssb_timer_callback(__rte_unused struct rte_timer *tim, void *arg);
 
-        // Per DRB Per Cell Measurement Callback
+        // Per DRB Per Cell Measurement Callback. Arg is the sample_group, first DRB group is sampled if it is NULL.
         void per_drb_per_cell_timer_callback(__rte_unused struct rte_timer *tim, void *arg);
 
+        // Per SSB callback of a single socket in multi socket mode. Arg is the sample_group_socket to drain.
+        void per_socket_ssb_timer_callback(__rte_unused struct rte_timer *tim, void *arg);
+
+        // Service callback. Arg is the logger_service. Returns -EAGAIN if nothing was due.
+        int32_t service_callback(void *arg);
+
         // Public Deconstructor
         ~LoggerLib();
 
     private:    
-    // Timers to periodically sample SSB values. They are always sampled with 1sec period
-    rte_timer per_ssb_timer;
-
     // For holding data, maps are preferred since they allow for O(log n) search which I believe will happen quite often.
     // ID's that belong to per_ssb_metrics. 
-    std::map<int, per_ssb_measurements> per_ssb_data;
+    std::map<int, per_ssb_state> per_ssb_data;
     
     std::map<int, per_drb_measurements> drb_measurement_map;
+
+    // Held while registrations change the measurement maps, sample groups and the cell count buffer, and while the
+    // logger lcores or readers on other lcores walk them. Taken before ssb_publish_lock, rollup_lock and trigger_lock.
+    rte_spinlock_t registration_lock;
+
+    // Results of the last completed SSB period indexed by SSB ID. Written only in the SSB timer callbacks.
+    // Groups may finish on different lcores in multi socket mode, publishing is serialized with the lock.
+    SnapshotBuffer<per_ssb_measurements> ssb_snapshot;
+
+    rte_spinlock_t ssb_publish_lock;
+
+    // Results of the last DRB sampling indexed by DRB ID. Written only in the DRB timer callbacks.
+    SnapshotBuffer<per_drb_statistics> drb_snapshot;
+
+    // Sample groups per kind in creation order.
+    std::vector<sample_group *> ssb_groups;
+
+    std::vector<sample_group *> drb_groups;
+
+    // Groups that published the last snapshot. Their entries are carried to the next buffer.
+    sample_group *last_ssb_group;
+
+    sample_group *last_drb_group;
+
+    // Protects the reporting period accumulators from readers and registrations.
+    rte_spinlock_t rollup_lock;
     
     CURRENT_METRIC_HANDLER metric_handler;
     
-    // Which core logger is attached to
+    // Which lcore the timers are attached to
     int current_core_id;
 
-    // Sampling Frequency for measurements. Must be at least 10Hz
-    int ue_sampling_frequency;
+    // True if the logger is created with per socket logger lcores. Metric handler is not used in this mode.
+    bool multi_socket_mode;
+
+    // Per lcore metric shards indexed by lcore ID. Only filled in multi socket mode.
+    std::vector<MetricInterface *> lcore_shards;
+
+    // Shards that exist, so that reads do not walk every lcore slot.
+    std::vector<MetricInterface *> active_shards;
+
+    // Socket states in multi socket mode.
+    std::vector<per_socket_shard *> socket_shards;
+
+    // Periodic callbacks of the logger. Tasks are only appended, count is published after a task is filled
+    // so LoggerTick on other lcores can read the list without a lock.
+    logger_period_task period_tasks[MAX_PERIOD_TASKS];
+
+    uint32_t period_task_count;
+
+    // Increased every time a task is added or rescheduled.
+    uint32_t task_generation;
+
+    // Scheduling state indexed by logger lcore ID.
+    std::vector<lcore_task_state> task_states;
+
+    // Registered services, empty unless register_services is called.
+    std::vector<logger_service *> services;
+
+    // Packed UE counts of all cells of all DRB's gathered in DRB order in each sampling. Sized to total cell count.
+    std::vector<uint64_t> cell_count_buffer;
+
+    // Min, max and sum kernel for the cell counts. Selected once at initialization for the CPU.
+    packed_count_aggregate_fn aggregate_kernel;
+
+    // Optional binary export of the periodic results.
+    ReportEncoder *report_encoder;
+
+    // Time source of the logger. Points to tsc_clock unless another clock is set.
+    LoggerClock *clock;
+
+    TscClock tsc_clock;
+
+    // Optional recorder of the API calls.
+    TraceRecorder *trace_recorder;
+
+    // Trigger rules per measurement type. Rules are added on the registration lcore while the sampling lcores
+    // evaluate them, so the lists are protected by the lock. Measurement maps are protected by registration_lock.
+    std::vector<trigger_rule> ssb_trigger_rules;
+
+    std::vector<trigger_rule> cell_trigger_rules;
+
+    rte_spinlock_t trigger_lock;
+
+    int next_trigger_rule_id;
+
+    // Notifications of triggered rules. Multi producer since SSB and DRB timers may run on different lcores.
+    rte_ring *trigger_ring;
+
+    uint64_t dropped_trigger_events;
+
+    // Number of heavy hitters to report. Zero if heavy hitter tracking is disabled.
+    unsigned int heavy_hitter_top_k;
+
+    // Sketches per lcore, source and slot. Period N is counted in slot N % HEAVY_HITTER_SKETCH_SLOTS.
+    std::vector<HeavyHitterSketch *> heavy_hitter_sketches;
 
-    // When was the last reading of the UE values occured for per drb per cell measurements.
-    uint64_t ue_last_sampled_time;
+    uint64_t heavy_hitter_period;
 
-    // Timer to generate callbacks for sampling for per drb per cell measurements.
-    rte_timer per_drb_per_cell_measurement_timer;
+    // Sum of the sketches of all lcores, used while merging.
+    std::vector<uint64_t> heavy_hitter_counters;
+
+    // Heavy hitters of the last merged period indexed by source.
+    SnapshotBuffer<heavy_hitter_report> heavy_hitter_snapshot;
 
     // Available ID for the SSB.    
     int ssb_first_available_id;
 
-    // Previos Timer Tick Time
-    int prev_tsc;
+    // Ring that producers in other processes push events into. NULL until create_event_ring is called.
+    rte_ring *event_ring;
+
+    uint64_t invalid_events;
 
     // A helper function to retrieve Active and Inactive UE's for per DRB per Cell.
     bool get_active_inactive_ue_count(int drb_id, int cell_id, uint32_t &active_count, uint32_t &inactive_count);
+
+    // Register a metric in the metric handler or in every lcore shard depending on the mode.
+    bool register_metric(const char *metric_name, int &id);
+
+    // Read a metric value. In multi socket mode, values of all lcore shards are summed.
+    bool read_metric(int metric_id, uint64_t &metric_value);
+
+    // Add to a metric value. In multi socket mode, the shard of the calling lcore is updated.
+    bool add_to_metric(int metric_id, int64_t value);
+
+    // Metric shard of the calling lcore in multi socket mode. NULL if the lcore has no shard.
+    MetricInterface *current_lcore_shard();
+
+    /** Create a period task. First deadline is one period from now. Tasks are never removed or rescheduled.
+     * @param task_id Set to the ID of the new task
+     * **/
+    bool schedule_period_task(int &task_id, uint64_t period_cycles, unsigned int lcore_id, rte_timer_cb_t callback, void *arg);
+
+    /** Run the tasks of the lcore if the cached next deadline has passed or the tasks have changed.
+     * @returns True if the tasks were checked
+     * **/
+    bool poll_period_tasks(unsigned int lcore_id, uint64_t now);
+
+    // Run the tasks of the lcore whose deadline has passed and compute the next deadline.
+    void run_period_tasks(unsigned int lcore_id, uint64_t now);
+
+    // Update the jitter values and metrics of an lcore with the lateness of a period callback.
+    void record_period_jitter(lcore_task_state &state, uint64_t jitter_cycles);
+
+    // Initialization shared by the constructors. Allocations are done on the given socket.
+    void initialize_state(int socket_id);
+
+    // Allocate the notification ring and reset the rule state. Ring is left NULL and rules can not be added if it fails.
+    void initialize_triggers(int socket_id);
+
+    // Evaluate the rules of the SSB's of the group with the values of the period that is being published.
+    void evaluate_ssb_triggers(per_ssb_measurements *snapshot, sample_group *group);
+
+    // Evaluate the rules of the cells of the group with the gathered cell counts of the last sampling.
+    void evaluate_cell_triggers(sample_group *group);
+
+    void push_trigger_event(trigger_rule &rule, int64_t value, double reference, uint64_t timestamp);
+
+    // Find the group of the given period or create it and arm its period tasks.
+    sample_group *get_sample_group(uint8_t kind, uint64_t period_cycles);
+
+    // Sample the SSB's of a group and publish them. In multi socket mode, values the sockets drained for @param socket_period are merged.
+    void publish_ssb_group(sample_group *group, uint64_t socket_period);
+
+    /** Add a sample to every reporting period of a measurement. Must be called with the rollup lock held.
+     * Completed windows are appended to @param completed with their report entry ID.
+     * **/
+    void update_rollups(std::vector<rollup_resolution> &rollups, int id, const uint64_t *values, uint64_t timestamp,
+                            std::vector<std::pair<int, measurement_rollup> > &completed);
+
+    // Write the windows completed in a sampling to the report stream.
+    void report_rollups(uint8_t record_type, uint64_t period, uint8_t value_count, 
+                            const std::vector<std::pair<int, measurement_rollup> > &completed);
+
+    // Delete the sketches of every lcore. Only safe while heavy hitter tracking is disabled or being torn down.
+    void free_heavy_hitter_sketches();
+
+    // Add weight to the sketch of the calling lcore.
+    void update_heavy_hitters(uint8_t source, uint32_t key, uint64_t weight);
+
+    // Start the next period, then merge the sketches of the period before the finished one and publish the heavy hitters.
+    void rotate_heavy_hitters();
+
+    // Decode a sampled SSB value into its measurements and report it.
+    void publish_ssb_period(int ssb_id, per_ssb_measurements &measurements, uint64_t packed_value);
 };
 
 
@@ -0,0 +1,78 @@
+#include "logger_producer.h"
+#include "stdio.h"
+
+LoggerProducer::LoggerProducer(const char *ring_name) : ring_name(ring_name), ring(NULL), dropped_events(0){
+    attach();
+}
+
+bool LoggerProducer::attach(){
+    if(ring != NULL){
+        return true;
+    }
+
+    ring = rte_ring_lookup(ring_name);
+
+    if(ring == NULL){
+        printf("Logger event ring %s is not found, primary logger has not created it yet\n", ring_name);
+        return false;
+    }
+
+    return true;
+}
+
+bool LoggerProducer::is_attached(){
+    return ring != NULL;
+}
+
+bool LoggerProducer::push(uint8_t type, int id, int cell_id, uint8_t prach_type, uint32_t count, bool new_ue){
+    struct rte_ring_zc_data zcd;
+
+    if(ring == NULL || rte_ring_enqueue_zc_burst_elem_start(ring, sizeof(logger_event), 1, &zcd, NULL) == 0){
+        __atomic_fetch_add(&dropped_events, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    // Fill the slot in the ring directly, a single element is never split.
+    logger_event *event = (logger_event *) zcd.ptr1;
+
+    event->type = type;
+    event->prach_type = prach_type;
+    event->new_ue = new_ue;
+    event->reserved = 0;
+    event->id = id;
+    event->cell_id = cell_id;
+    event->count = count;
+
+    rte_ring_enqueue_zc_elem_finish(ring, 1);
+    return true;
+}
+
+bool LoggerProducer::push_prach(int ssb_id, uint8_t type, uint32_t count){
+    return push(LOGGER_EVENT_PRACH, ssb_id, 0, type, count, true);
+}
+
+bool LoggerProducer::push_active_ue(int drb_id, int cell_id, uint32_t count, bool new_ue){
+    return push(LOGGER_EVENT_ACTIVE_UE, drb_id, cell_id, 0, count, new_ue);
+}
+
+bool LoggerProducer::push_inactive_ue(int drb_id, int cell_id, uint32_t count, bool new_ue){
+    return push(LOGGER_EVENT_INACTIVE_UE, drb_id, cell_id, 0, count, new_ue);
+}
+
+unsigned int LoggerProducer::push_events(const logger_event *events, unsigned int count){
+    unsigned int pushed = 0;
+
+    if(ring != NULL){
+        pushed = rte_ring_enqueue_burst_elem(ring, events, sizeof(logger_event), count, NULL);
+    }
+
+    if(pushed < count){
+        __atomic_fetch_add(&dropped_events, count - pushed, __ATOMIC_RELAXED);
+    }
+
+    return pushed;
+}
+
+uint64_t LoggerProducer::get_dropped_event_count(){
+    return __atomic_load_n(&dropped_events, __ATOMIC_RELAXED);
+}
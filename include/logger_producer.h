@@ -0,0 +1,46 @@
+#ifndef DPDK_LOGGER_PRODUCER_H
+#define DPDK_LOGGER_PRODUCER_H
+
+#include "rte_common.h"
+#include "rte_ring.h"
+#include "logger_event.h"
+
+/** Producer side of the event ring for secondary processes. Only depends on the ring, so the process that owns the
+ * measurements does not need to be linked in. Events are written in place into the ring slots.
+ * Many lcores and processes can push to the same ring. IDs of SSB's and DRB's are the ones given by the primary logger.
+ * */
+class LoggerProducer {
+    public:
+        // Tries to attach to the ring with the given name. Use attach to retry if the primary has not created it yet.
+        LoggerProducer(const char *ring_name = LOGGER_EVENT_RING_NAME);
+
+        // Look up the ring in shared memory. Returns false if it does not exist.
+        bool attach();
+
+        bool is_attached();
+
+        bool push_prach(int ssb_id, uint8_t type, uint32_t count = 1);
+
+        bool push_active_ue(int drb_id, int cell_id, uint32_t count, bool new_ue = true);
+
+        bool push_inactive_ue(int drb_id, int cell_id, uint32_t count, bool new_ue = true);
+
+        /** Push already filled events in a single burst.
+         * @returns Number of events pushed, rest are dropped
+         * **/
+        unsigned int push_events(const logger_event *events, unsigned int count);
+
+        // Number of events dropped because the ring was full or not attached.
+        uint64_t get_dropped_event_count();
+
+    private:
+        bool push(uint8_t type, int id, int cell_id, uint8_t prach_type, uint32_t count, bool new_ue);
+
+        const char *ring_name;
+
+        struct rte_ring *ring;
+
+        uint64_t dropped_events;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "measurement_rollup.h"
+#include "string.h"
+
+static void reset_window(measurement_rollup &window){
+    window.sample_count = 0;
+    window.window_end = 0;
+
+    for(unsigned int i = 0; i < ROLLUP_MAX_VALUES; i++){
+        window.min[i] = UINT64_MAX;
+        window.max[i] = 0;
+        window.sum[i] = 0;
+    }
+}
+
+void initialize_rollup(rollup_resolution &resolution, uint32_t period_ms, uint32_t samples_per_window, uint8_t value_count){
+    resolution.samples_per_window = samples_per_window;
+    resolution.value_count = value_count;
+    resolution.has_last = false;
+
+    resolution.current.period_ms = period_ms;
+    reset_window(resolution.current);
+
+    memset(&resolution.last, 0, sizeof(measurement_rollup));
+    resolution.last.period_ms = period_ms;
+}
+
+bool add_rollup_sample(rollup_resolution &resolution, const uint64_t *values, uint64_t timestamp){
+    measurement_rollup &window = resolution.current;
+
+    for(unsigned int i = 0; i < resolution.value_count; i++){
+        window.min[i] = values[i] < window.min[i] ? values[i] : window.min[i];
+        window.max[i] = values[i] > window.max[i] ? values[i] : window.max[i];
+        window.sum[i] += values[i];
+    }
+
+    window.sample_count++;
+    window.window_end = timestamp;
+
+    if(window.sample_count < resolution.samples_per_window){
+        return false;
+    }
+
+    resolution.last = window;
+    resolution.has_last = true;
+    reset_window(window);
+
+    return true;
+}
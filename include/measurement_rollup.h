@@ -0,0 +1,66 @@
+#ifndef DPDK_LOGGER_MEASUREMENT_ROLLUP_H
+#define DPDK_LOGGER_MEASUREMENT_ROLLUP_H
+
+#include "rte_common.h"
+
+// Measurements that rollups can be attached to
+// PRACH counts of an SSB per sample. Values are PRACH_DEDICATED, PRACH_RAND_HIGH and PRACH_RAND_LOW counts.
+#define ROLLUP_SOURCE_SSB 1U
+// UE counts of a DRB per sample. Values are total active and total inactive UE's of its cells.
+#define ROLLUP_SOURCE_DRB 2U
+
+// Maximum number of values in a sample
+#define ROLLUP_MAX_VALUES 3
+
+// Maximum number of reporting periods per measurement
+#ifndef ROLLUP_MAX_RESOLUTIONS
+    #define ROLLUP_MAX_RESOLUTIONS 4
+#endif
+
+// Summary of the samples in a reporting window.
+struct measurement_rollup{
+
+    // Reporting period in milliseconds
+    uint32_t period_ms;
+
+    uint32_t sample_count;
+
+    // Logger clock time of the last sample in the window
+    uint64_t window_end;
+
+    uint64_t min[ROLLUP_MAX_VALUES];
+
+    uint64_t max[ROLLUP_MAX_VALUES];
+
+    uint64_t sum[ROLLUP_MAX_VALUES];
+};
+
+// Running accumulator of one reporting period of a measurement. Window length is counted in samples,
+// so adding a sample is constant time and no timer is needed per reporting period.
+struct rollup_resolution{
+
+    uint32_t samples_per_window;
+
+    uint8_t value_count;
+
+    // Window that is being accumulated
+    measurement_rollup current;
+
+    // Last completed window
+    measurement_rollup last;
+
+    // True after the first window is completed
+    bool has_last;
+};
+
+/** Prepare an accumulator for windows of @param samples_per_window samples.
+ * @param value_count Number of values in each sample, at most ROLLUP_MAX_VALUES
+ * **/
+void initialize_rollup(rollup_resolution &resolution, uint32_t period_ms, uint32_t samples_per_window, uint8_t value_count);
+
+/** Add a sample to the current window.
+ * @returns True if the sample completed the window. Completed window is moved to last and a new window is started.
+ * **/
+bool add_rollup_sample(rollup_resolution &resolution, const uint64_t *values, uint64_t timestamp);
+
+#endif
@@ -2,6 +2,7 @@
 #define DPDK_LOGGER_CLASS_METRIC_INTERFACE_H
 
 #include "rte_eal.h"
+#include "vector"
 
 class MetricInterface{
     public:
@@ -24,6 +25,12 @@ class MetricInterface{
         // Get the metric value by ID.
         virtual bool get_metric(int metric_id, uint64_t &metric_value) = 0;
 
+        // Get the metric value by ID and set it back to zero. Used at the end of a sampling period.
+        virtual bool get_and_reset_metric(int metric_id, uint64_t &metric_value) = 0;
+
+        // Read every registered metric at once. @param metric_values is resized and indexed by metric ID.
+        virtual bool get_all_metrics(std::vector<uint64_t> &metric_values) = 0;
+
 
     protected:
         // Print the Currently Registered Metrics to screen. Should be used for testing purposes. Real Outputting will be done in
@@ -0,0 +1,260 @@
+#include "report_encoder.h"
+#include "varint.h"
+#include "string.h"
+
+
+ReportEncoder::ReportEncoder(FILE *output, uint32_t keyframe_interval) : output(output), keyframe_interval(keyframe_interval), total_bytes(0){
+    rte_spinlock_init(&lock);
+    rte_spinlock_init(&output_lock);
+
+    pending.insert(pending.end(), REPORT_STREAM_MAGIC, REPORT_STREAM_MAGIC + 4);
+    pending.push_back(REPORT_STREAM_VERSION);
+    total_bytes = pending.size();
+}
+
+ReportEncoder::~ReportEncoder(){
+    flush();
+}
+
+void ReportEncoder::begin_record(uint8_t type, uint64_t period, uint8_t field_count){
+    rte_spinlock_lock(&lock);
+
+    record_type = type;
+    record_period = period;
+    record_field_count = field_count > REPORT_MAX_FIELDS ? REPORT_MAX_FIELDS : field_count;
+    record_keyframe = true;
+    record_entry_count = 0;
+    record_previous_id = 0;
+    record_body.clear();
+}
+
+void ReportEncoder::add_entry(int id, const int64_t *fields){
+    entry_state &state = entry_states[record_type][id];
+    bool keyframe = keyframe_interval == 0 || state.entry_count % keyframe_interval == 0;
+
+    state.values.resize(record_field_count, 0);
+    state.entry_count++;
+
+    put_varint(record_body, (zigzag_encode((int64_t) id - record_previous_id) << 1) | (keyframe ? 1 : 0));
+
+    for(unsigned int i = 0; i < record_field_count; i++){
+        put_varint(record_body, zigzag_encode(keyframe ? fields[i] : fields[i] - state.values[i]));
+        state.values[i] = fields[i];
+    }
+
+    record_keyframe = record_keyframe && keyframe;
+    record_previous_id = id;
+    record_entry_count++;
+}
+
+bool ReportEncoder::end_record(){
+    size_t record_start = pending.size();
+
+    pending.push_back(record_type);
+    pending.push_back(record_keyframe ? REPORT_FLAG_KEYFRAME : 0);
+    put_varint(pending, record_period);
+    put_varint(pending, record_field_count);
+    put_varint(pending, record_entry_count);
+    put_varint(pending, record_body.size());
+    pending.insert(pending.end(), record_body.begin(), record_body.end());
+
+    total_bytes += pending.size() - record_start;
+    bool full = pending.size() >= REPORT_FLUSH_SIZE;
+
+    rte_spinlock_unlock(&lock);
+
+    return full ? write_pending(false) : true;
+}
+
+bool ReportEncoder::flush(){
+    bool result = write_pending(true);
+    fflush(output);
+
+    return result;
+}
+
+uint64_t ReportEncoder::bytes_written(){
+    return total_bytes;
+}
+
+bool ReportEncoder::write_pending(bool wait){
+    if(wait){
+        rte_spinlock_lock(&output_lock);
+    }else if(!rte_spinlock_trylock(&output_lock)){
+        // Lcore that is writing picks these records up with its next flush.
+        return true;
+    }
+
+    // Buffers are swapped so that encoding continues into the empty one while this chunk is written.
+    rte_spinlock_lock(&lock);
+    writing.swap(pending);
+    rte_spinlock_unlock(&lock);
+
+    bool result = write_bytes(writing.data(), writing.size());
+    writing.clear();
+
+    rte_spinlock_unlock(&output_lock);
+    return result;
+}
+
+bool ReportEncoder::write_bytes(const uint8_t *data, size_t length){
+    if(length == 0){
+        return true;
+    }
+
+    if(fwrite(data, 1, length, output) != length){
+        printf("Cannot write report stream\n");
+        return false;
+    }
+
+    return true;
+}
+
+ReportDecoder::ReportDecoder() : read_offset(0), header_read(false), version(0), corrupt(false), skipped_entries(0){
+
+}
+
+void ReportDecoder::feed(const uint8_t *data, size_t length){
+    // Drop already decoded bytes before growing the buffer.
+    if(read_offset > 0){
+        buffer.erase(buffer.begin(), buffer.begin() + read_offset);
+        read_offset = 0;
+    }
+
+    buffer.insert(buffer.end(), data, data + length);
+}
+
+bool ReportDecoder::next_record(report_record &record){
+    if(corrupt){
+        return false;
+    }
+
+    if(!header_read){
+        if(buffer.size() - read_offset < 5){
+            return false;
+        }
+
+        if(memcmp(&buffer[read_offset], REPORT_STREAM_MAGIC, 4) != 0 || buffer[read_offset + 4] < REPORT_STREAM_MIN_VERSION || 
+                buffer[read_offset + 4] > REPORT_STREAM_VERSION){
+            corrupt = true;
+            return false;
+        }
+
+        version = buffer[read_offset + 4];
+        read_offset += 5;
+        header_read = true;
+    }
+
+    // Parse the record header without consuming anything until the whole record is available.
+    size_t offset;
+    uint64_t period, field_count, entry_count, body_length;
+    uint8_t type;
+    uint8_t flags;
+
+    while(true){
+        offset = read_offset;
+
+        if(buffer.size() - offset < 2){
+            return false;
+        }
+
+        type = buffer[offset++];
+        flags = buffer[offset++];
+
+        if(!get_varint(buffer, offset, period) || !get_varint(buffer, offset, field_count) || 
+                !get_varint(buffer, offset, entry_count) || !get_varint(buffer, offset, body_length)){
+            return false;
+        }
+
+        if(buffer.size() - offset < body_length){
+            return false;
+        }
+
+        if(type >= REPORT_RECORD_SSB && type <= REPORT_RECORD_DRB_ROLLUP){
+            break;
+        }
+
+        // Record type of a newer version, its fields may not fit in an entry.
+        read_offset = offset + body_length;
+    }
+
+    if(field_count > REPORT_MAX_FIELDS){
+        corrupt = true;
+        return false;
+    }
+
+    size_t body_end = offset + body_length;
+    bool record_keyframe = flags & REPORT_FLAG_KEYFRAME;
+    std::map<int, std::vector<int64_t> > &previous_of_type = previous_values[type];
+    int previous_id = 0;
+
+    record.type = type;
+    record.keyframe = record_keyframe;
+    record.period = period;
+    record.entries.clear();
+
+    for(uint64_t i = 0; i < entry_count; i++){
+        report_entry entry;
+        uint64_t value;
+
+        if(!get_varint(buffer, offset, value) || offset > body_end){
+            corrupt = true;
+            return false;
+        }
+
+        // Older versions have no keyframe bit, the record flag applies to every entry.
+        if(version >= 3){
+            entry.keyframe = value & 1;
+            value >>= 1;
+        }else{
+            entry.keyframe = record_keyframe;
+        }
+
+        entry.id = previous_id + (int) zigzag_decode(value);
+        entry.field_count = field_count;
+        previous_id = entry.id;
+
+        // Without a keyframe of the ID there is nothing to add the differences to. Older versions start IDs from zero.
+        std::map<int, std::vector<int64_t> >::iterator it = previous_of_type.find(entry.id);
+        bool known = it != previous_of_type.end();
+
+        if(!known && (entry.keyframe || version < 3)){
+            it = previous_of_type.insert(std::make_pair(entry.id, std::vector<int64_t>())).first;
+            known = true;
+        }
+
+        if(known){
+            it->second.resize(field_count, 0);
+        }
+
+        for(unsigned int j = 0; j < field_count; j++){
+            if(!get_varint(buffer, offset, value) || offset > body_end){
+                corrupt = true;
+                return false;
+            }
+
+            if(known){
+                entry.fields[j] = entry.keyframe ? zigzag_decode(value) : it->second[j] + zigzag_decode(value);
+                it->second[j] = entry.fields[j];
+            }
+        }
+
+        if(!known){
+            skipped_entries++;
+            continue;
+        }
+
+        record.entries.push_back(entry);
+    }
+
+    read_offset = body_end;
+    return true;
+}
+
+bool ReportDecoder::is_corrupt(){
+    return corrupt;
+}
+
+uint64_t ReportDecoder::get_skipped_entry_count(){
+    return skipped_entries;
+}
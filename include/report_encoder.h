@@ -0,0 +1,185 @@
+#ifndef DPDK_LOGGER_REPORT_ENCODER_H
+#define DPDK_LOGGER_REPORT_ENCODER_H
+
+#include "rte_common.h"
+#include "rte_spinlock.h"
+#include "stdio.h"
+#include "vector"
+#include "map"
+
+/** Binary report stream format, all integers are LEB128 varints unless noted otherwise:
+ * - Stream header: 4 byte magic "LGRS", 1 byte version
+ * - Record: 1 byte type, 1 byte flags, period, field count per entry, entry count, body length in bytes, body
+ * - Body: for every entry, zig-zag encoded ID difference from the previous entry of the record shifted left by one with
+ *   the keyframe bit in the lowest bit, then field values.
+ *   Field values are zig-zag encoded differences from the previous entry of the same ID and record type.
+ *   In keyframe entries, differences are taken from zero. Every ID has its own keyframe countdown, so IDs that
+ *   are not in every record of their type are still decodable from their next keyframe entry.
+ *   Keyframe flag of a record is set when all of its entries are keyframes.
+ * Unknown record types are skipped with the body length before their field count is checked.
+ * Version 2 added the rollup records and raised the field limit from 8 to 12. Version 1 decoders check the field
+ * count of every record, so they reject a version 2 stream at its header instead.
+ * Version 3 moved keyframes from records to entries. In older versions the keyframe flag applies to every entry.
+ * */
+#define REPORT_STREAM_MAGIC "LGRS"
+#define REPORT_STREAM_VERSION 3
+
+// Oldest version the decoder reads.
+#define REPORT_STREAM_MIN_VERSION 1
+
+#define REPORT_RECORD_SSB 1U
+#define REPORT_RECORD_DRB 2U
+// Completed reporting windows. Entry ID is measurement ID * ROLLUP_MAX_RESOLUTIONS + index of the reporting period.
+// Fields are period in milliseconds, sample count, then min, max and sum of every sample value.
+#define REPORT_RECORD_SSB_ROLLUP 3U
+#define REPORT_RECORD_DRB_ROLLUP 4U
+
+#define REPORT_FLAG_KEYFRAME 0x01
+
+#define REPORT_MAX_FIELDS 12
+
+// Encoded records are buffered and written out once this many bytes are pending. Applications that call
+// ReportEncoder::flush off the fast path can raise it so that records are never written on the sampling lcore.
+#ifndef REPORT_FLUSH_SIZE
+    #define REPORT_FLUSH_SIZE 65536
+#endif
+
+// One decoded entry of a record.
+struct report_entry{
+
+    int id;
+
+    bool keyframe;
+
+    uint8_t field_count;
+
+    int64_t fields[REPORT_MAX_FIELDS];
+};
+
+// One decoded record.
+struct report_record{
+
+    uint8_t type;
+
+    // All entries are keyframes
+    bool keyframe;
+
+    uint64_t period;
+
+    std::vector<report_entry> entries;
+};
+
+/** Encodes periodic results into the report stream. Records of different types may be written from different lcores,
+ * each record is encoded into a buffer under a lock. Buffer is written to the file outside that lock, so lcores
+ * encoding records never wait for the file.
+ * */
+class ReportEncoder {
+    public:
+        /** @param output File to write the stream to. It is not closed by the encoder.
+         * @param keyframe_interval Every Nth entry of each ID is a keyframe. The first entry of an ID always is.
+         * **/
+        ReportEncoder(FILE *output, uint32_t keyframe_interval);
+
+        // Pending records are flushed.
+        ~ReportEncoder();
+
+        // Start a new record. Entries must be added in increasing ID order.
+        void begin_record(uint8_t type, uint64_t period, uint8_t field_count);
+
+        void add_entry(int id, const int64_t *fields);
+
+        // Finish the record. Pending records are written out if more than REPORT_FLUSH_SIZE bytes are buffered.
+        bool end_record();
+
+        /** Write every pending record to the file and flush it. Meant to be called regularly from an lcore
+         * that is not sampling.
+         * **/
+        bool flush();
+
+        // Number of bytes of the stream so far, including the ones that are not written out yet.
+        uint64_t bytes_written();
+
+    private:
+        FILE *output;
+
+        uint32_t keyframe_interval;
+
+        rte_spinlock_t lock;
+
+        // Held while a chunk is written so that chunks reach the file in order.
+        rte_spinlock_t output_lock;
+
+        uint64_t total_bytes;
+
+        // Encoded records that are not written yet, and the chunk that is being written
+        std::vector<uint8_t> pending;
+
+        std::vector<uint8_t> writing;
+
+        // State of the record that is being written
+        uint8_t record_type;
+        bool record_keyframe;
+        uint8_t record_field_count;
+        uint64_t record_period;
+        uint32_t record_entry_count;
+        int record_previous_id;
+        std::vector<uint8_t> record_body;
+
+        // Delta base of an ID within a record type
+        struct entry_state{
+            // Entries written for the ID. Used to place keyframes.
+            uint64_t entry_count;
+
+            std::vector<int64_t> values;
+
+            entry_state() : entry_count(0){}
+        };
+
+        std::map<uint8_t, std::map<int, entry_state> > entry_states;
+
+        bool write_bytes(const uint8_t *data, size_t length);
+
+        /** Move the pending records to the file.
+         * @param wait If false, returns without writing when another lcore is already writing
+         * **/
+        bool write_pending(bool wait);
+};
+
+/** Streaming decoder for the report stream. Data can be fed in chunks of any size and records are returned
+ * as soon as they are complete.
+ * */
+class ReportDecoder {
+    public:
+        ReportDecoder();
+
+        // Append data read from the stream.
+        void feed(const uint8_t *data, size_t length);
+
+        /** Decode the next complete record. Records of unknown types are skipped.
+         * @returns False if more data is needed or the stream is corrupt. Check is_corrupt to tell them apart.
+         * **/
+        bool next_record(report_record &record);
+
+        bool is_corrupt();
+
+        // Number of entries dropped because their ID had no keyframe yet, which happens when decoding starts mid stream.
+        uint64_t get_skipped_entry_count();
+
+    private:
+        std::vector<uint8_t> buffer;
+
+        size_t read_offset;
+
+        bool header_read;
+
+        uint8_t version;
+
+        bool corrupt;
+
+        uint64_t skipped_entries;
+
+        // Last decoded values per type and ID. An ID is missing until its first keyframe entry.
+        std::map<uint8_t, std::map<int, std::vector<int64_t> > > previous_values;
+};
+
+#endif
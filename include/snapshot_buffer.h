@@ -0,0 +1,111 @@
+#ifndef DPDK_LOGGER_SNAPSHOT_BUFFER_H
+#define DPDK_LOGGER_SNAPSHOT_BUFFER_H
+
+#include "rte_malloc.h"
+#include "string.h"
+
+/** Double buffered snapshot of periodic results. A single writer fills the buffer that readers are not looking at
+ * and publishes it by increasing the sequence number. Readers on any lcore copy an entry out of the published buffer
+ * and retry only if a new period was published during the copy, so they never block the writer and the writer never
+ * waits for them. Writer must write or carry forward every entry it wants readers to see in each period.
+ * */
+template <typename T>
+class SnapshotBuffer {
+    public:
+        SnapshotBuffer() : capacity(0), sequence(0){
+            buffers[0] = NULL;
+            buffers[1] = NULL;
+        }
+
+        ~SnapshotBuffer(){
+            rte_free(buffers[0]);
+            rte_free(buffers[1]);
+        }
+
+        bool is_initialized() const {
+            return buffers[0] != NULL;
+        }
+
+        // Allocate both buffers on the given socket. Entry indexes must be less than @param entry_count
+        bool initialize(unsigned int entry_count, int socket_id){
+            buffers[0] = (T *) rte_zmalloc_socket("logger_snapshot", sizeof(T) * entry_count, RTE_CACHE_LINE_SIZE, socket_id);
+            buffers[1] = (T *) rte_zmalloc_socket("logger_snapshot", sizeof(T) * entry_count, RTE_CACHE_LINE_SIZE, socket_id);
+
+            if(buffers[0] == NULL || buffers[1] == NULL){
+                rte_free(buffers[0]);
+                rte_free(buffers[1]);
+                buffers[0] = NULL;
+                buffers[1] = NULL;
+
+                return false;
+            }
+
+            capacity = entry_count;
+            return true;
+        }
+
+        // Start writing the next period. Returned buffer is not visible to readers until end_write is called.
+        T *begin_write(){
+            // Publishing of the previous period must be visible before any of the new writes.
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            return buffers[(sequence + 1) & 1];
+        }
+
+        /** Copy an entry of the last published period into the buffer that is being written. Only the entries written
+         * in the last period differ between the buffers, so a writer that updates a subset of the entries only needs to
+         * carry those forward.
+         * **/
+        void carry_forward(unsigned int index){
+            if(index < capacity){
+                buffers[(sequence + 1) & 1][index] = buffers[sequence & 1][index];
+            }
+        }
+
+        // Publish the buffer returned by begin_write.
+        void end_write(){
+            __atomic_store_n(&sequence, sequence + 1, __ATOMIC_RELEASE);
+        }
+
+        /** Copy an entry of the last published period.
+         * @returns False if the index is out of range or nothing is published yet
+         * **/
+        bool read(unsigned int index, T &value, uint64_t *period = NULL) const {
+            uint64_t begin_sequence;
+
+            if(index >= capacity){
+                return false;
+            }
+
+            do{
+                begin_sequence = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+
+                if(begin_sequence == 0){
+                    return false;
+                }
+
+                memcpy(&value, &buffers[begin_sequence & 1][index], sizeof(T));
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            }while(__atomic_load_n(&sequence, __ATOMIC_RELAXED) != begin_sequence);
+
+            if(period != NULL){
+                *period = begin_sequence;
+            }
+
+            return true;
+        }
+
+        // Number of published periods.
+        uint64_t published_periods() const {
+            return __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+        }
+
+    private:
+        T *buffers[2];
+
+        unsigned int capacity;
+
+        // Number of the last published period. Buffer of period N is buffers[N & 1].
+        uint64_t sequence;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "socket_metric_interface.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+
+
+SocketMetricInterface::SocketMetricInterface() : socket_id(SOCKET_ID_ANY), metric_count(0), values(NULL){
+
+}
+
+
+SocketMetricInterface::~SocketMetricInterface(){
+    rte_free(values);
+}
+
+
+bool SocketMetricInterface::initialize_metrics(void *data){
+    socket_id = *((int *)data);
+    values = (uint64_t *) rte_zmalloc_socket("logger_socket_metrics", sizeof(uint64_t) * SOCKET_METRIC_CAPACITY,
+                                                RTE_CACHE_LINE_SIZE, socket_id);
+
+    if(values == NULL){
+        printf("Cannot allocate metric storage on socket %d\n", socket_id);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool SocketMetricInterface::register_metric(__rte_unused const char *metric_name, int &id){
+    if(values == NULL || metric_count == SOCKET_METRIC_CAPACITY){
+        return false;
+    }
+
+    id = metric_count++;
+    return true;
+}
+
+
+bool SocketMetricInterface::update_metric(int metric_id, int64_t value, bool absolute){
+    if(metric_id < 0 || metric_id >= metric_count){
+        return false;
+    }
+
+    if(absolute){
+        __atomic_store_n(&values[metric_id], (uint64_t) value, __ATOMIC_RELAXED);
+    }else{
+        __atomic_fetch_add(&values[metric_id], (uint64_t) value, __ATOMIC_RELAXED);
+    }
+
+    return true;
+}
+
+bool SocketMetricInterface::get_metric(int metric_id, uint64_t &metric_value){
+    if(metric_id < 0 || metric_id >= metric_count){
+        return false;
+    }
+
+    metric_value = __atomic_load_n(&values[metric_id], __ATOMIC_RELAXED);
+    return true;
+}
+
+bool SocketMetricInterface::get_and_reset_metric(int metric_id, uint64_t &metric_value){
+    if(metric_id < 0 || metric_id >= metric_count){
+        return false;
+    }
+
+    metric_value = __atomic_exchange_n(&values[metric_id], 0, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool SocketMetricInterface::get_all_metrics(std::vector<uint64_t> &metric_values){
+    if(values == NULL){
+        return false;
+    }
+
+    metric_values.resize(metric_count);
+
+    for(int i = 0; i < metric_count; i++){
+        metric_values[i] = __atomic_load_n(&values[i], __ATOMIC_RELAXED);
+    }
+
+    return true;
+}
+
+
+void SocketMetricInterface::print_metrics(){
+    printf("Metrics for socket %d is %d units long\n", socket_id, metric_count);
+
+    for(int i = 0; i < metric_count; i++){
+        printf("  %d -> %" PRIu64 "\n", i, values[i]);
+    }
+}
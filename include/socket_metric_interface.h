@@ -0,0 +1,50 @@
+#ifndef DPDK_LOGGER_SOCKET_METRIC_INTERFACE_H
+#define DPDK_LOGGER_SOCKET_METRIC_INTERFACE_H
+
+#include "metric_interface.h"
+#include "rte_eal.h"
+#include "rte_malloc.h"
+
+// Maximum number of metrics a single shard can hold. rte_metrics is limited to 256 metrics in total
+// so this interface is also used when more SSBs or cells are needed.
+#ifndef SOCKET_METRIC_CAPACITY
+    #define SOCKET_METRIC_CAPACITY 16384
+#endif
+
+/** Metric interface that keeps its values in a flat array allocated with rte_zmalloc_socket on a given socket.
+ * Logger uses one instance per lcore in multi socket mode so that every lcore writes into memory on its own socket.
+ * Relative updates and resets are atomic, so a logger lcore can drain the values while the owner lcore keeps writing.
+ * Absolute updates are plain stores and should only be done by the owner lcore.
+ * */
+class SocketMetricInterface : public MetricInterface {
+    public:
+        SocketMetricInterface();
+
+        ~SocketMetricInterface();
+
+        // Data is a pointer to the int socket id that the metric storage is allocated on.
+        bool initialize_metrics(void *data);
+
+        bool register_metric(const char *metric_name, int &id);
+
+        bool update_metric(int metric_id, int64_t value, bool absolute);
+
+        bool get_metric(int metric_id, uint64_t &metric_value);
+
+        bool get_and_reset_metric(int metric_id, uint64_t &metric_value);
+
+        bool get_all_metrics(std::vector<uint64_t> &metric_values);
+
+    protected:
+        void print_metrics();
+
+    private:
+        int socket_id;
+
+        // Number of registered metrics. Metric IDs are simply indexes in the values array.
+        int metric_count;
+
+        uint64_t *values;
+};
+
+#endif
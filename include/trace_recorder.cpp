@@ -0,0 +1,139 @@
+#include "trace_recorder.h"
+#include "varint.h"
+#include "string.h"
+
+// Records are buffered and written in chunks of this size.
+#define TRACE_FLUSH_SIZE 65536
+
+// Longest possible record: type, argument count, timestamp and arguments as 10 byte varints.
+#define TRACE_MAX_RECORD_SIZE (2 + 10 * (TRACE_MAX_ARGS + 1))
+
+
+TraceRecorder::TraceRecorder(FILE *output, uint64_t hz) : output(output), previous_timestamp(0), record_count(0){
+    rte_spinlock_init(&lock);
+
+    for(unsigned int i = 0; i < 4; i++){
+        buffer.push_back(TRACE_MAGIC[i]);
+    }
+
+    buffer.push_back(TRACE_VERSION);
+    put_varint(buffer, hz);
+}
+
+TraceRecorder::~TraceRecorder(){
+    // File is not touched if everything was flushed, it may already be closed.
+    if(!buffer.empty()){
+        flush();
+    }
+}
+
+void TraceRecorder::record(uint8_t type, uint64_t timestamp, const int64_t *args, uint8_t arg_count){
+    rte_spinlock_lock(&lock);
+
+    // Records of different lcores can arrive slightly out of order. Keep the deltas positive.
+    if(timestamp < previous_timestamp){
+        timestamp = previous_timestamp;
+    }
+
+    buffer.push_back(type);
+    buffer.push_back(arg_count);
+    put_varint(buffer, timestamp - previous_timestamp);
+
+    for(unsigned int i = 0; i < arg_count; i++){
+        put_varint(buffer, zigzag_encode(args[i]));
+    }
+
+    previous_timestamp = timestamp;
+    record_count++;
+
+    if(buffer.size() >= TRACE_FLUSH_SIZE){
+        fwrite(buffer.data(), 1, buffer.size(), output);
+        buffer.clear();
+    }
+
+    rte_spinlock_unlock(&lock);
+}
+
+void TraceRecorder::flush(){
+    rte_spinlock_lock(&lock);
+
+    fwrite(buffer.data(), 1, buffer.size(), output);
+    fflush(output);
+    buffer.clear();
+
+    rte_spinlock_unlock(&lock);
+}
+
+uint64_t TraceRecorder::get_record_count(){
+    return record_count;
+}
+
+
+TraceReader::TraceReader(FILE *input) : input(input), valid(false), hz(0), timestamp(0), offset(0){
+    fill(5 + 10);
+
+    if(buffer.size() < 6 || memcmp(buffer.data(), TRACE_MAGIC, 4) != 0 || buffer[4] != TRACE_VERSION){
+        return;
+    }
+
+    offset = 5;
+    valid = get_varint(buffer, offset, hz);
+}
+
+bool TraceReader::is_valid(){
+    return valid;
+}
+
+uint64_t TraceReader::get_hz(){
+    return hz;
+}
+
+bool TraceReader::next_record(trace_record &record){
+    uint64_t value;
+
+    if(!valid){
+        return false;
+    }
+
+    fill(TRACE_MAX_RECORD_SIZE);
+
+    if(buffer.size() - offset < 2){
+        return false;
+    }
+
+    record.type = buffer[offset++];
+    record.arg_count = buffer[offset++];
+
+    if(record.arg_count > TRACE_MAX_ARGS || !get_varint(buffer, offset, value)){
+        return false;
+    }
+
+    timestamp += value;
+    record.timestamp = timestamp;
+
+    for(unsigned int i = 0; i < record.arg_count; i++){
+        if(!get_varint(buffer, offset, value)){
+            return false;
+        }
+
+        record.args[i] = zigzag_decode(value);
+    }
+
+    return true;
+}
+
+void TraceReader::fill(size_t length){
+    if(buffer.size() - offset >= length){
+        return;
+    }
+
+    // Drop consumed bytes and read the next chunk.
+    buffer.erase(buffer.begin(), buffer.begin() + offset);
+    offset = 0;
+
+    size_t old_size = buffer.size();
+    buffer.resize(old_size + TRACE_FLUSH_SIZE);
+
+    size_t read_size = fread(buffer.data() + old_size, 1, TRACE_FLUSH_SIZE, input);
+    buffer.resize(old_size + read_size);
+}
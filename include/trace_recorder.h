@@ -0,0 +1,111 @@
+#ifndef DPDK_LOGGER_TRACE_RECORDER_H
+#define DPDK_LOGGER_TRACE_RECORDER_H
+
+#include "rte_common.h"
+#include "rte_spinlock.h"
+#include "stdio.h"
+#include "vector"
+
+/** Binary trace format, all integers are LEB128 varints unless noted otherwise:
+ * - Trace header: 4 byte magic "LGTR", 1 byte version, clock frequency in Hz
+ * - Record: 1 byte type, 1 byte argument count, cycles since the previous record, zig-zag encoded arguments
+ * Registrations record the ID that the logger returned as their last argument so that replays can be checked.
+ * */
+#define TRACE_MAGIC "LGTR"
+#define TRACE_VERSION 1
+
+#define TRACE_MAX_ARGS 4
+
+// Record types
+// add_new_ssb. Arguments: sample period in milliseconds, SSB ID. Older traces only have the SSB ID.
+#define TRACE_ADD_SSB 1U
+// add_new_drb. Arguments: UE sampling frequency, DRB ID
+#define TRACE_ADD_DRB 2U
+// add_new_cell_to_drb. Arguments: DRB ID, cell ID
+#define TRACE_ADD_CELL 3U
+// on_ssb_prach_receive. Arguments: SSB ID, PRACH type, count
+#define TRACE_PRACH 4U
+// add_new_active_ue_to_cell. Arguments: DRB ID, cell ID, count, new UE
+#define TRACE_ACTIVE_UE 5U
+// add_new_inactive_ue_to_cell. Arguments: DRB ID, cell ID, count, new UE
+#define TRACE_INACTIVE_UE 6U
+// SSB period callback has run. Arguments: sample group index. Older traces have no arguments.
+#define TRACE_SSB_PERIOD 7U
+// DRB sampling callback has run. Arguments: sample group index. Older traces have no arguments.
+#define TRACE_DRB_PERIOD 8U
+// add_reporting_period. Arguments: rollup source, SSB or DRB ID, period in milliseconds
+#define TRACE_ADD_ROLLUP 9U
+
+struct trace_record{
+
+    uint8_t type;
+
+    uint8_t arg_count;
+
+    // Absolute time of the record in cycles of the recording clock
+    uint64_t timestamp;
+
+    int64_t args[TRACE_MAX_ARGS];
+};
+
+/** Records logger API calls to a file. Calls from different lcores are serialized with a lock,
+ * so recording is meant for capturing load, not for production use.
+ * */
+class TraceRecorder {
+    public:
+        // @param hz Frequency of the clock the timestamps are taken from
+        TraceRecorder(FILE *output, uint64_t hz);
+
+        // Records that were not flushed yet are written. The file is not closed.
+        ~TraceRecorder();
+
+        void record(uint8_t type, uint64_t timestamp, const int64_t *args, uint8_t arg_count);
+
+        // Write buffered records to the file.
+        void flush();
+
+        uint64_t get_record_count();
+
+    private:
+        FILE *output;
+
+        rte_spinlock_t lock;
+
+        uint64_t previous_timestamp;
+
+        uint64_t record_count;
+
+        std::vector<uint8_t> buffer;
+};
+
+// Reads a trace written by TraceRecorder.
+class TraceReader {
+    public:
+        TraceReader(FILE *input);
+
+        // False if the file is not a trace.
+        bool is_valid();
+
+        uint64_t get_hz();
+
+        // Read the next record. False at the end of the trace or if the record is truncated.
+        bool next_record(trace_record &record);
+
+    private:
+        FILE *input;
+
+        bool valid;
+
+        uint64_t hz;
+
+        uint64_t timestamp;
+
+        std::vector<uint8_t> buffer;
+
+        size_t offset;
+
+        // Make sure at least @param length bytes are buffered after the offset if the file has them.
+        void fill(size_t length);
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "trigger_rules.h"
+#include <math.h>
+
+
+
+bool evaluate_trigger_rule(trigger_rule &rule, int64_t value, double &reference){
+    bool condition = false;
+
+    switch (rule.kind)
+    {
+    case TRIGGER_THRESHOLD_ABOVE:
+        reference = rule.threshold;
+        condition = value > rule.threshold;
+        break;
+
+    case TRIGGER_THRESHOLD_BELOW:
+        reference = rule.threshold;
+        condition = value < rule.threshold;
+        break;
+
+    case TRIGGER_RATE_OF_CHANGE: {
+        reference = rule.previous_value;
+
+        if(rule.sample_count > 0){
+            double change = value - rule.previous_value;
+            condition = rule.threshold >= 0 ? change > rule.threshold : change < rule.threshold;
+        }
+
+        break;
+    }
+
+    case TRIGGER_EWMA_DEVIATION: {
+        reference = rule.ewma_mean;
+
+        if(rule.sample_count == 0){
+            rule.ewma_mean = value;
+            rule.ewma_variance = 0;
+            break;
+        }
+
+        double difference = value - rule.ewma_mean;
+
+        if(rule.sample_count >= TRIGGER_EWMA_WARMUP_SAMPLES){
+            condition = fabs(difference) > rule.threshold * sqrt(rule.ewma_variance);
+        }
+
+        double increment = rule.ewma_alpha * difference;
+        rule.ewma_mean += increment;
+        rule.ewma_variance = (1 - rule.ewma_alpha) * (rule.ewma_variance + difference * increment);
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    rule.previous_value = value;
+    rule.sample_count++;
+
+    bool triggered = condition && !rule.condition_active;
+    rule.condition_active = condition;
+
+    return triggered;
+}
@@ -0,0 +1,91 @@
+#ifndef DPDK_LOGGER_TRIGGER_RULES_H
+#define DPDK_LOGGER_TRIGGER_RULES_H
+
+#include "rte_common.h"
+
+// Kinds of trigger rules
+// Value is above the threshold
+#define TRIGGER_THRESHOLD_ABOVE 1U
+// Value is below the threshold
+#define TRIGGER_THRESHOLD_BELOW 2U
+// Change from the previous sample is larger than the threshold. A negative threshold triggers on drops.
+#define TRIGGER_RATE_OF_CHANGE 3U
+// Value deviates from its exponentially weighted moving average by more than threshold standard deviations
+#define TRIGGER_EWMA_DEVIATION 4U
+
+// Measurements that rules can be attached to
+// PRACH count of an SSB in the last period. Sub ID is the PRACH type.
+#define TRIGGER_SOURCE_SSB_PRACH 1U
+// Active UE count of a cell in the last sampling. Sub ID is the cell ID in the DRB.
+#define TRIGGER_SOURCE_CELL_ACTIVE_UE 2U
+// Inactive UE count of a cell in the last sampling. Sub ID is the cell ID in the DRB.
+#define TRIGGER_SOURCE_CELL_INACTIVE_UE 3U
+
+// Number of samples EWMA rules wait before they can trigger
+#ifndef TRIGGER_EWMA_WARMUP_SAMPLES
+    #define TRIGGER_EWMA_WARMUP_SAMPLES 8
+#endif
+
+// A registered rule and its running state. Rules are edge triggered, an event is only generated when the condition
+// becomes true so a measurement that stays over the threshold does not flood the notification ring.
+struct trigger_rule{
+
+    int rule_id;
+
+    uint8_t kind;
+
+    uint8_t source;
+
+    // SSB ID or DRB ID
+    int entity_id;
+
+    // PRACH type or cell ID
+    int sub_id;
+
+    double threshold;
+
+    // Weight of the new sample in EWMA rules
+    double ewma_alpha;
+
+    // Running state
+    bool condition_active;
+
+    uint64_t sample_count;
+
+    int64_t previous_value;
+
+    double ewma_mean;
+
+    double ewma_variance;
+};
+
+// Notification of a triggered rule. Size is a multiple of 4 so it can be stored in an rte_ring directly.
+struct trigger_event{
+
+    int rule_id;
+
+    uint8_t kind;
+
+    uint8_t source;
+
+    int entity_id;
+
+    int sub_id;
+
+    // Sampled value that triggered the rule
+    int64_t value;
+
+    // Threshold, previous value or EWMA mean depending on the kind
+    double reference;
+
+    // TSC of the sample
+    uint64_t timestamp;
+};
+
+/** Feed a new sample to the rule and update its running state.
+ * @param reference Filled with the value the sample is compared against
+ * @returns True if the rule has just triggered
+ * **/
+bool evaluate_trigger_rule(trigger_rule &rule, int64_t value, double &reference);
+
+#endif
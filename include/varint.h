@@ -0,0 +1,46 @@
+#ifndef DPDK_LOGGER_VARINT_H
+#define DPDK_LOGGER_VARINT_H
+
+#include "rte_common.h"
+#include "vector"
+
+// LEB128 varint and zig-zag helpers shared by the binary report and trace formats.
+
+static inline void put_varint(std::vector<uint8_t> &out, uint64_t value){
+    while(value >= 0x80){
+        out.push_back((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back((uint8_t) value);
+}
+
+// Returns false if the buffer ends before the varint does or the varint is too long.
+static inline bool get_varint(const std::vector<uint8_t> &in, size_t &offset, uint64_t &value){
+    value = 0;
+
+    for(unsigned int shift = 0; shift < 64; shift += 7){
+        if(offset >= in.size()){
+            return false;
+        }
+
+        uint8_t byte = in[offset++];
+        value |= ((uint64_t) (byte & 0x7F)) << shift;
+
+        if(!(byte & 0x80)){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline uint64_t zigzag_encode(int64_t value){
+    return (((uint64_t) value) << 1) ^ (uint64_t) (value >> 63);
+}
+
+static inline int64_t zigzag_decode(uint64_t value){
+    return (int64_t) (value >> 1) ^ -((int64_t) (value & 1));
+}
+
+#endif
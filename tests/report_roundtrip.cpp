@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <report_encoder.h>
+#include <varint.h>
+
+/** Encodes a report stream with two SSB groups that write records of the same type in turns and a rollup record
+ * type whose IDs are not in every record, then decodes it from the start and from the middle.
+ * Every decoded value must match the encoded one, and decoding from the middle must pick up every ID.
+ * */
+
+#define KEYFRAME_INTERVAL 3
+#define RECORD_COUNT 24
+#define FIELD_COUNT 3
+
+// Record where decoding from the middle starts. Not a multiple of anything above on purpose.
+#define MIDDLE_RECORD 7
+
+static int failures = 0;
+
+static void check(bool condition, const char *message){
+    if(!condition){
+        printf("FAIL: %s\n", message);
+        failures++;
+    }
+}
+
+static int64_t field_value(uint8_t type, int id, uint64_t period, unsigned int field){
+    return (int64_t) (type * 100000 + id * 1000 + period * (field + 1)) * (period % 4 == 3 ? -1 : 1);
+}
+
+// IDs of the record with the given period. SSB groups alternate, rollup IDs complete their windows at different rates.
+static std::vector<int> record_ids(uint8_t type, uint64_t period){
+    std::vector<int> ids;
+
+    if(type == REPORT_RECORD_SSB){
+        if(period % 2 == 0){
+            ids.push_back(0);
+            ids.push_back(1);
+        }else{
+            ids.push_back(2);
+            ids.push_back(3);
+            ids.push_back(4);
+        }
+    }else{
+        ids.push_back(10);
+
+        if(period % 3 == 0){
+            ids.push_back(11);
+        }
+
+        if(period % 5 == 0){
+            ids.push_back(12);
+        }
+    }
+
+    return ids;
+}
+
+static void write_record(ReportEncoder &encoder, uint8_t type, uint64_t period){
+    std::vector<int> ids = record_ids(type, period);
+    int64_t fields[FIELD_COUNT];
+
+    encoder.begin_record(type, period, FIELD_COUNT);
+
+    for(unsigned int i = 0; i < ids.size(); i++){
+        for(unsigned int j = 0; j < FIELD_COUNT; j++){
+            fields[j] = field_value(type, ids[i], period, j);
+        }
+
+        encoder.add_entry(ids[i], fields);
+    }
+
+    encoder.end_record();
+}
+
+/** Decode @param stream and check every entry.
+ * @returns Number of distinct IDs seen per record type, SSB IDs first
+ * **/
+static std::vector<int> decode_and_check(const std::vector<uint8_t> &stream, uint64_t &skipped){
+    ReportDecoder decoder;
+    report_record record;
+    std::vector<bool> seen(13, false);
+
+    decoder.feed(stream.data(), stream.size());
+
+    while(decoder.next_record(record)){
+        for(unsigned int i = 0; i < record.entries.size(); i++){
+            report_entry &entry = record.entries[i];
+
+            check(entry.id >= 0 && entry.id < (int) seen.size(), "decoded ID is in range");
+            check(entry.field_count == FIELD_COUNT, "decoded field count matches");
+
+            for(unsigned int j = 0; j < FIELD_COUNT && j < entry.field_count; j++){
+                check(entry.fields[j] == field_value(record.type, entry.id, record.period, j), "decoded value matches");
+            }
+
+            seen[entry.id] = true;
+        }
+    }
+
+    check(!decoder.is_corrupt(), "stream is not corrupt");
+    skipped = decoder.get_skipped_entry_count();
+
+    std::vector<int> seen_counts(2, 0);
+
+    for(unsigned int i = 0; i < seen.size(); i++){
+        seen_counts[i >= 10] += seen[i];
+    }
+
+    return seen_counts;
+}
+
+static void test_roundtrip(){
+    FILE *file = tmpfile();
+    ReportEncoder encoder(file, KEYFRAME_INTERVAL);
+    long middle = 0;
+
+    for(uint64_t period = 0; period < RECORD_COUNT; period++){
+        if(period == MIDDLE_RECORD){
+            encoder.flush();
+            middle = ftell(file);
+        }
+
+        write_record(encoder, REPORT_RECORD_SSB, period);
+        write_record(encoder, REPORT_RECORD_SSB_ROLLUP, period);
+    }
+
+    encoder.flush();
+
+    std::vector<uint8_t> stream(ftell(file));
+    rewind(file);
+    check(fread(stream.data(), 1, stream.size(), file) == stream.size(), "stream is read back");
+    fclose(file);
+
+    uint64_t skipped;
+    std::vector<int> seen = decode_and_check(stream, skipped);
+
+    check(seen[0] == 5 && seen[1] == 3, "every ID is decoded from the start");
+    check(skipped == 0, "nothing is skipped from the start");
+
+    // Stream header followed by the records from the middle.
+    std::vector<uint8_t> tail(stream.begin(), stream.begin() + 5);
+    tail.insert(tail.end(), stream.begin() + middle, stream.end());
+
+    seen = decode_and_check(tail, skipped);
+
+    check(seen[0] == 5 && seen[1] == 3, "every ID is decoded from the middle");
+    check(skipped > 0, "entries before the first keyframe of their ID are skipped");
+}
+
+// Version 2 streams have the keyframe only in the record flags and no keyframe bit in the IDs.
+static void test_version_2(){
+    std::vector<uint8_t> stream(REPORT_STREAM_MAGIC, REPORT_STREAM_MAGIC + 4);
+    stream.push_back(2);
+
+    for(unsigned int period = 0; period < 2; period++){
+        std::vector<uint8_t> body;
+
+        // IDs 4 and 6, values 10 then 13
+        put_varint(body, zigzag_encode(4));
+        put_varint(body, zigzag_encode(period == 0 ? 10 : 3));
+        put_varint(body, zigzag_encode(2));
+        put_varint(body, zigzag_encode(period == 0 ? 10 : 3));
+
+        stream.push_back(REPORT_RECORD_DRB);
+        stream.push_back(period == 0 ? REPORT_FLAG_KEYFRAME : 0);
+        put_varint(stream, period);
+        put_varint(stream, 1);
+        put_varint(stream, 2);
+        put_varint(stream, body.size());
+        stream.insert(stream.end(), body.begin(), body.end());
+    }
+
+    ReportDecoder decoder;
+    report_record record;
+    decoder.feed(stream.data(), stream.size());
+
+    for(unsigned int period = 0; period < 2; period++){
+        check(decoder.next_record(record), "version 2 record is decoded");
+        check(record.entries.size() == 2, "version 2 record has both entries");
+
+        for(unsigned int i = 0; i < record.entries.size(); i++){
+            check(record.entries[i].id == (int) (4 + 2 * i), "version 2 ID matches");
+            check(record.entries[i].fields[0] == (period == 0 ? 10 : 13), "version 2 value matches");
+        }
+    }
+}
+
+int main(){
+    test_roundtrip();
+    test_version_2();
+
+    if(failures > 0){
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("Report stream round trip passed\n");
+    return 0;
+}
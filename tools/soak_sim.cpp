@@ -0,0 +1,211 @@
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <rte_eal.h>
+#include <rte_debug.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+
+#include <logger_lib.h>
+
+/** Drives a logger with generated load on a simulated clock. Sampling and reporting periods fire as the simulated time
+ * advances, so a long soak run with many cells finishes in seconds and gives the same reports on every run.
+ * Usage: soak_sim [EAL options] -- [--hours <h>] [--ssbs <n>] [--drbs <n>] [--cells <n>] [--events <n>]
+ *                                  [--frequency <hz>] [--report <report file>]
+ *  --hours      Simulated duration, default 24
+ *  --ssbs       SSB count, default 64
+ *  --drbs       DRB count, cells are spread over them, default 100
+ *  --cells      Cell count, default 10000
+ *  --events     PRACH and UE events per simulated second, default 1000
+ *  --frequency  UE sampling frequency of the DRBs, default 1
+ *  --report     Write the binary report stream
+ * */
+
+// Simulated time is advanced in steps of 10 ms, events of the step are generated before it.
+#define SOAK_STEPS_PER_SECOND 100
+
+static void usage(const char *name){
+    printf("Usage: %s [EAL options] -- [--hours <h>] [--ssbs <n>] [--drbs <n>] [--cells <n>] [--events <n>] "
+           "[--frequency <hz>] [--report <report file>]\n", name);
+}
+
+// Fixed seed xorshift, so that the load is the same on every run.
+static uint64_t next_random(uint64_t &state){
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+int main(int argc, char **argv){
+    int ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_panic("Cannot init EAL\n");
+
+    const char *program_name = argv[0];
+    argc -= ret;
+    argv += ret;
+
+    double hours = 24;
+    int ssb_count = 64;
+    int drb_count = 100;
+    int cell_count = 10000;
+    uint64_t events_per_second = 1000;
+    int ue_sampling_frequency = 1;
+    const char *report_path = NULL;
+
+    for(int i = 1; i < argc; i++){
+        if(i + 1 >= argc){
+            usage(program_name);
+            return 1;
+        }
+
+        if(strcmp(argv[i], "--hours") == 0){
+            hours = atof(argv[++i]);
+        }else if(strcmp(argv[i], "--ssbs") == 0){
+            ssb_count = atoi(argv[++i]);
+        }else if(strcmp(argv[i], "--drbs") == 0){
+            drb_count = atoi(argv[++i]);
+        }else if(strcmp(argv[i], "--cells") == 0){
+            cell_count = atoi(argv[++i]);
+        }else if(strcmp(argv[i], "--events") == 0){
+            events_per_second = strtoull(argv[++i], NULL, 10);
+        }else if(strcmp(argv[i], "--frequency") == 0){
+            ue_sampling_frequency = atoi(argv[++i]);
+        }else if(strcmp(argv[i], "--report") == 0){
+            report_path = argv[++i];
+        }else{
+            usage(program_name);
+            return 1;
+        }
+    }
+
+    if(hours <= 0 || ssb_count <= 0 || drb_count <= 0 || cell_count < drb_count || ue_sampling_frequency <= 0){
+        usage(program_name);
+        return 1;
+    }
+
+    // Cells are kept in per lcore shards in multi socket mode, single metric library is limited to RTE_METRICS_MAX_METRICS.
+    std::vector<unsigned int> logger_lcores(1, rte_lcore_id());
+    LoggerLib *logger = new LoggerLib(logger_lcores);
+    VirtualClock *clock = new VirtualClock(rte_get_timer_hz());
+    logger->set_clock(clock);
+
+    FILE *report_file = NULL;
+    ReportEncoder *encoder = NULL;
+
+    if(report_path != NULL){
+        report_file = fopen(report_path, "wb");
+
+        if(report_file == NULL){
+            printf("Cannot open report file %s\n", report_path);
+            return 1;
+        }
+
+        encoder = new ReportEncoder(report_file, 60);
+        logger->set_report_encoder(encoder);
+    }
+
+    std::vector<int> ssb_ids;
+    std::vector<std::pair<int, int> > cells;
+
+    for(int i = 0; i < ssb_count; i++){
+        int id;
+
+        if(!logger->add_new_ssb(id)){
+            rte_panic("Cannot add SSB %d\n", i);
+        }
+
+        ssb_ids.push_back(id);
+    }
+
+    for(int i = 0; i < drb_count; i++){
+        int drb_id;
+
+        if(!logger->add_new_drb(drb_id, ue_sampling_frequency)){
+            rte_panic("Cannot add DRB %d\n", i);
+        }
+
+        // Remaining cells go to the first DRBs.
+        int drb_cells = cell_count / drb_count + (i < cell_count % drb_count);
+
+        for(int j = 0; j < drb_cells; j++){
+            int cell_id;
+
+            if(!logger->add_new_cell_to_drb(drb_id, cell_id)){
+                rte_panic("Cannot add cell %d to DRB %d\n", j, drb_id);
+            }
+
+            cells.push_back(std::make_pair(drb_id, cell_id));
+        }
+    }
+
+    uint64_t hz = clock->get_hz();
+    uint64_t step_cycles = hz / SOAK_STEPS_PER_SECOND;
+    uint64_t step_count = hours * 3600 * SOAK_STEPS_PER_SECOND;
+    uint64_t random_state = 0x9E3779B97F4A7C15UL;
+    uint64_t event_count = 0;
+    uint64_t callback_count = 0;
+    uint64_t event_remainder = 0;
+
+    uint64_t real_start = rte_rdtsc();
+
+    for(uint64_t step = 0; step < step_count; step++){
+        // Spread the events of a second over its steps without losing the remainder.
+        event_remainder += events_per_second;
+        uint64_t step_events = event_remainder / SOAK_STEPS_PER_SECOND;
+        event_remainder %= SOAK_STEPS_PER_SECOND;
+
+        for(uint64_t i = 0; i < step_events; i++){
+            uint64_t random = next_random(random_state);
+
+            // Half of the events are PRACH messages, rest are new UEs of the cells.
+            switch (random & 3)
+            {
+            case 0:
+            case 1:
+                logger->on_ssb_prach_receive(ssb_ids[(random >> 8) % ssb_ids.size()], PRACH_DEDICATED + (random >> 2) % 3);
+                break;
+
+            case 2: {
+                std::pair<int, int> &cell = cells[(random >> 8) % cells.size()];
+                logger->add_new_active_ue_to_cell(cell.first, cell.second, 1);
+                break;
+            }
+
+            default: {
+                std::pair<int, int> &cell = cells[(random >> 8) % cells.size()];
+                logger->add_new_inactive_ue_to_cell(cell.first, cell.second, 1);
+                break;
+            }
+            }
+        }
+
+        event_count += step_events;
+        callback_count += logger->run_simulation_until((step + 1) * step_cycles);
+    }
+
+    double real_seconds = (double) (rte_rdtsc() - real_start) / rte_get_tsc_hz();
+    double simulated_seconds = (double) clock->get_cycles() / hz;
+
+    printf("Simulated %.0f s with %d SSBs and %zu cells in %.3f s, %.0fx real time\n",
+                simulated_seconds, ssb_count, cells.size(), real_seconds, simulated_seconds / real_seconds);
+    printf("%" PRIu64 " events, %" PRIu64 " period callbacks\n", event_count, callback_count);
+
+    logger->set_report_encoder(NULL);
+    delete logger;
+    delete encoder;
+    delete clock;
+
+    if(report_file != NULL){
+        fclose(report_file);
+    }
+
+    rte_eal_cleanup();
+
+    return 0;
+}
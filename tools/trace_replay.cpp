@@ -0,0 +1,302 @@
+#include <iostream>
+#include <map>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <rte_eal.h>
+#include <rte_debug.h>
+#include <rte_cycles.h>
+#include <rte_pause.h>
+#include <rte_lcore.h>
+
+#include <logger_lib.h>
+
+/** Replays a trace recorded with TraceRecorder into a new logger. Logger runs on a virtual clock that follows the
+ * timestamps of the trace and period callbacks are run where the trace has them, so the reports only depend on the trace.
+ * Usage: trace_replay [EAL options] -- <trace file> [--fast] [--report <report file>]
+ *  --fast    Replay as fast as possible instead of the original timing
+ *  --report  Write the binary report stream, reports of two library versions can be compared with cmp
+ * */
+
+static void usage(const char *name){
+    printf("Usage: %s [EAL options] -- <trace file> [--fast] [--report <report file>]\n", name);
+}
+
+// Fewest arguments a record of @param type can have, older traces have less arguments for some types.
+static uint8_t min_arg_count(uint8_t type){
+    switch (type)
+    {
+    case TRACE_ADD_SSB:
+        return 1;
+    case TRACE_ADD_DRB:
+    case TRACE_ADD_CELL:
+        return 2;
+    case TRACE_PRACH:
+    case TRACE_ADD_ROLLUP:
+        return 3;
+    case TRACE_ACTIVE_UE:
+    case TRACE_INACTIVE_UE:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+// Find the ID this logger gave for @param trace_id. False if the trace used an ID that was never registered.
+static bool map_id(const std::map<int, int> &ids, int64_t trace_id, int &id){
+    std::map<int, int>::const_iterator it = ids.find(trace_id);
+
+    if(it == ids.end()){
+        return false;
+    }
+
+    id = it->second;
+    return true;
+}
+
+int main(int argc, char **argv){
+    int ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_panic("Cannot init EAL\n");
+
+    const char *program_name = argv[0];
+    argc -= ret;
+    argv += ret;
+
+    const char *trace_path = NULL;
+    const char *report_path = NULL;
+    bool fast = false;
+
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--fast") == 0){
+            fast = true;
+        }else if(strcmp(argv[i], "--report") == 0 && i + 1 < argc){
+            report_path = argv[++i];
+        }else if(trace_path == NULL){
+            trace_path = argv[i];
+        }else{
+            usage(program_name);
+            return 1;
+        }
+    }
+
+    if(trace_path == NULL){
+        usage(program_name);
+        return 1;
+    }
+
+    FILE *trace_file = fopen(trace_path, "rb");
+    if(trace_file == NULL){
+        printf("Cannot open trace %s\n", trace_path);
+        return 1;
+    }
+
+    TraceReader reader(trace_file);
+    if(!reader.is_valid()){
+        printf("%s is not a logger trace\n", trace_path);
+        return 1;
+    }
+
+    FILE *report_file = NULL;
+    ReportEncoder *encoder = NULL;
+
+    LoggerLib *logger = new LoggerLib(rte_socket_id());
+    VirtualClock *clock = new VirtualClock(reader.get_hz());
+    logger->set_clock(clock);
+
+    if(report_path != NULL){
+        report_file = fopen(report_path, "wb");
+
+        if(report_file == NULL){
+            printf("Cannot open report file %s\n", report_path);
+            return 1;
+        }
+
+        encoder = new ReportEncoder(report_file, 60);
+        logger->set_report_encoder(encoder);
+    }
+
+    // IDs given by this logger are mapped to the IDs in the trace. They should be the same unless registration changed.
+    std::map<int, int> ssb_ids;
+    std::map<int, int> drb_ids;
+    uint64_t mismatched_ids = 0;
+    uint64_t failed_registrations = 0;
+    uint64_t unmapped_ids = 0;
+    uint64_t malformed_records = 0;
+    uint64_t record_count = 0;
+
+    trace_record record;
+    uint64_t first_timestamp = 0;
+    uint64_t real_start = rte_rdtsc();
+    uint64_t real_hz = rte_get_tsc_hz();
+
+    while(reader.next_record(record)){
+        if(record_count == 0){
+            first_timestamp = record.timestamp;
+        }
+
+        // Wait until the same amount of real time has passed since the start.
+        if(!fast){
+            uint64_t target = real_start + (double) (record.timestamp - first_timestamp) * real_hz / reader.get_hz();
+
+            while(rte_rdtsc() < target){
+                rte_pause();
+            }
+        }
+
+        clock->set_cycles(record.timestamp);
+        record_count++;
+
+        if(record.arg_count < min_arg_count(record.type)){
+            malformed_records++;
+            continue;
+        }
+
+        switch (record.type)
+        {
+        case TRACE_ADD_SSB: {
+            int id;
+            int64_t trace_id = record.args[record.arg_count - 1];
+
+            // Older traces do not have the sample period.
+            if(!logger->add_new_ssb(id, record.arg_count > 1 ? record.args[0] : 1000)){
+                failed_registrations++;
+                break;
+            }
+
+            ssb_ids[trace_id] = id;
+            mismatched_ids += id != trace_id;
+            break;
+        }
+
+        case TRACE_ADD_DRB: {
+            int id;
+
+            if(!logger->add_new_drb(id, record.args[0])){
+                failed_registrations++;
+                break;
+            }
+
+            drb_ids[record.args[1]] = id;
+            mismatched_ids += id != record.args[1];
+            break;
+        }
+
+        case TRACE_ADD_CELL: {
+            int drb_id;
+            int cell_id;
+
+            if(!map_id(drb_ids, record.args[0], drb_id)){
+                unmapped_ids++;
+                break;
+            }
+
+            if(!logger->add_new_cell_to_drb(drb_id, cell_id)){
+                failed_registrations++;
+                break;
+            }
+
+            mismatched_ids += cell_id != record.args[1];
+            break;
+        }
+
+        case TRACE_PRACH: {
+            int id;
+
+            if(!map_id(ssb_ids, record.args[0], id)){
+                unmapped_ids++;
+                break;
+            }
+
+            logger->on_ssb_prach_receive(id, record.args[1], record.args[2]);
+            break;
+        }
+
+        case TRACE_ACTIVE_UE: {
+            int drb_id;
+
+            if(!map_id(drb_ids, record.args[0], drb_id)){
+                unmapped_ids++;
+                break;
+            }
+
+            logger->add_new_active_ue_to_cell(drb_id, record.args[1], record.args[2], record.args[3]);
+            break;
+        }
+
+        case TRACE_INACTIVE_UE: {
+            int drb_id;
+
+            if(!map_id(drb_ids, record.args[0], drb_id)){
+                unmapped_ids++;
+                break;
+            }
+
+            logger->add_new_inactive_ue_to_cell(drb_id, record.args[1], record.args[2], record.args[3]);
+            break;
+        }
+
+        case TRACE_ADD_ROLLUP: {
+            int id;
+
+            if(!map_id(record.args[0] == ROLLUP_SOURCE_SSB ? ssb_ids : drb_ids, record.args[1], id)){
+                unmapped_ids++;
+                break;
+            }
+
+            logger->add_reporting_period(record.args[0], id, record.args[2]);
+            break;
+        }
+
+        // Groups are created in the same order as the recording, older traces only have one group.
+        case TRACE_SSB_PERIOD:
+            logger->run_sample_group(SAMPLE_GROUP_SSB, record.arg_count > 0 ? record.args[0] : 0);
+            break;
+
+        case TRACE_DRB_PERIOD:
+            logger->run_sample_group(SAMPLE_GROUP_DRB, record.arg_count > 0 ? record.args[0] : 0);
+            break;
+
+        default:
+            printf("Unknown trace record type %u is skipped\n", record.type);
+            break;
+        }
+    }
+
+    double real_seconds = (double) (rte_rdtsc() - real_start) / real_hz;
+    double trace_seconds = (double) (record.timestamp - first_timestamp) / reader.get_hz();
+
+    printf("Replayed %" PRIu64 " records covering %.3f s of trace in %.3f s, %.0f records per second\n", 
+                record_count, trace_seconds, real_seconds, record_count / real_seconds);
+
+    if(mismatched_ids > 0){
+        printf("%" PRIu64 " registrations returned a different ID than the trace\n", mismatched_ids);
+    }
+
+    if(failed_registrations > 0){
+        printf("%" PRIu64 " registrations failed\n", failed_registrations);
+    }
+
+    if(unmapped_ids > 0){
+        printf("%" PRIu64 " records used an ID that was not registered and were skipped\n", unmapped_ids);
+    }
+
+    if(malformed_records > 0){
+        printf("%" PRIu64 " records had too few arguments and were skipped\n", malformed_records);
+    }
+
+    logger->set_report_encoder(NULL);
+    delete logger;
+    delete encoder;
+    delete clock;
+
+    if(report_file != NULL){
+        fclose(report_file);
+    }
+
+    fclose(trace_file);
+    rte_eal_cleanup();
+
+    return 0;
+}